@@ -4,6 +4,8 @@
 * Created:	2023.03.07
 */
 
+#include <cmath>
+
 #include "Asclepias.h"
 
 namespace ASC {
@@ -13,6 +15,16 @@ namespace ASC {
 		if (initialized_) {
 			return true;
 		}
+		if (loadState_ == LOADING) {
+			return false;
+		}
+		if (loadState_ != LOADED) {
+			preloadScene();
+		}
+		if (loadState_ == FAILED) {
+			loadState_ = UNLOADED;
+			return false;
+		}
 		initialized_ = init();
 		return initialized_;
 	}
@@ -22,9 +34,30 @@ namespace ASC {
 			return;
 		}
 		initialized_ = false;
+		loadState_ = UNLOADED;
+		progress_ = 0.0f;
+		App::tasks().cancel(this);
+		App::scheduler().removeAll(this);
 		destroy();
 	}
 
+	void Scene::startTask(Task&& task) {
+		App::tasks().start(std::move(task), this);
+	}
+
+	unsigned int Scene::addSystem(const std::string& name, double rate,
+		const TickScheduler::System& update, int phase) {
+		return App::scheduler().add(name, rate, update, phase, this);
+	}
+
+	void Scene::preloadScene() {
+		ASC_PROFILE_SCOPE("Scene::preload");
+		loadState_.store(LOADING, std::memory_order_relaxed);
+		bool loaded = preload();
+		progress_.store(1.0f, std::memory_order_relaxed);
+		loadState_.store(loaded ? LOADED : FAILED, std::memory_order_release);
+	}
+
 	// Define App functions.
 
 	App::Config::Config(Scene& scene) : startScene(scene) {}
@@ -36,32 +69,180 @@ namespace ASC {
 			return false;
 		}
 		inst_ = new App;
+		Profiler::SetEnabled(conf.log.profile);
+		ASC_PROFILE_THREAD("Main");
+		ASC_PROFILE_SCOPE("App::Init");
+		long long initStart = Profiler::Now();
 
-		inst_->log_.init(conf.log.console, conf.log.fileNames, conf.log.timestampFmt);
+		{
+			ASC_PROFILE_SCOPE("LogMgr::init");
+			inst_->log_.init(conf.log.console, conf.log.fileNames, conf.log.timestampFmt);
+		}
 		ASCLOG(App, Info, "Initialized logging system.");
 
-		if (!inst_->window_.init(conf.window.dims, conf.window.title, conf.window.fullscreen)) {
-			ASCLOG(App, Error, "Failed to initialize windowing module.");
-			return false;
+		{
+			ASC_PROFILE_SCOPE("JobMgr::init");
+			inst_->jobs_.init(conf.jobs.workers > 0 ? conf.jobs.workers
+				: JobMgr::GetDefaultWorkers());
+		}
+		ASCLOG(App, Info, "Initialized job system with ", inst_->jobs_.getWorkers(), " workers.");
+		inst_->tasks_.init(inst_->jobs_);
+		inst_->frameArena_.init(conf.memory.frameArenaSize);
+
+		// Start the work that does not need the window or OpenGL context so it overlaps creating
+		// them, the OpenGL uploads are done once the renderer is initialized.
+		JobCounter audio, loaders, assets;
+		bool loaded = false;
+		long long audioTime = 0, loadersTime = 0, fontsTime = 0;
+		std::atomic<long long> texturesTime = 0;
+		inst_->jobs_.submit([&conf, &audioTime]() {
+			ASC_PROFILE_SCOPE("AudioMgr::init");
+			long long start = Profiler::Now();
+			inst_->audio_.init(conf.audio.volume);
+			audioTime = Profiler::Now() - start;
+		}, &audio);
+		inst_->jobs_.submit([&conf, &loaded, &loadersTime]() {
+			ASC_PROFILE_SCOPE("Renderer::initLoaders");
+			long long start = Profiler::Now();
+			loaded = inst_->renderer_.initLoaders(conf.graphics.glyphCacheSize, conf.graphics.cacheDir);
+			loadersTime = Profiler::Now() - start;
+		}, &loaders);
+		for (const std::string& t : conf.assets.textures) {
+			inst_->jobs_.submit([&t, &texturesTime]() {
+				long long start = Profiler::Now();
+				inst_->renderer_.preloadTexture(t);
+				texturesTime += Profiler::Now() - start;
+			}, &assets);
 		}
+		if (!conf.assets.fonts.empty()) {
+			// Fonts are prepared one after another as FreeType is not safe to share.
+			inst_->jobs_.submit([&conf, &loaded, &fontsTime]() {
+				long long start = Profiler::Now();
+				for (const std::string& f : conf.assets.fonts) {
+					if (loaded) {
+						inst_->renderer_.preloadFont(f);
+					}
+				}
+				fontsTime = Profiler::Now() - start;
+			}, &assets, &loaders);
+		}
+
+		long long windowTime = Profiler::Now();
+		{
+			ASC_PROFILE_SCOPE("WindowMgr::init");
+			if (!inst_->window_.init(conf.window.dims, conf.window.title, conf.window.fullscreen,
+				conf.graphics.debugOutput)) {
+				ASCLOG(App, Error, "Failed to initialize windowing module.");
+				inst_->jobs_.wait(audio);
+				inst_->jobs_.wait(assets);
+				inst_->jobs_.wait(loaders);
+				return false;
+			}
+		}
+		windowTime = Profiler::Now() - windowTime;
 		ASCLOG(App, Info, "Initialized window.");
+		inst_->window_.setVsync(conf.window.vsync);
+		inst_->pacer_.init(conf.window.targetFPS, conf.window.vsync,
+			inst_->window_.getRefreshRate());
 
-		inst_->input_.init();
+		long long inputTime = Profiler::Now();
+		{
+			ASC_PROFILE_SCOPE("InputMgr::init");
+			inst_->input_.init();
+		}
+		inputTime = Profiler::Now() - inputTime;
 		ASCLOG(App, Info, "Initialized input manager.");
+		if (!conf.input.replayFile.empty() && inst_->input_.startReplay(conf.input.replayFile)
+			&& conf.input.replayHeadless) {
+			inst_->window_.setVisible(false);
+			inst_->window_.setVsync(false);
+			inst_->pacer_.setTargetFPS(-1.0);
+		}
+		else if (!conf.input.recordFile.empty()) {
+			inst_->input_.startRecording(conf.input.recordFile);
+		}
+
+		long long rendererTime = Profiler::Now();
+		{
+			ASC_PROFILE_SCOPE("Renderer::init");
+			inst_->jobs_.wait(loaders);
+			if (!loaded || !inst_->renderer_.init(conf.graphics.clearColor)) {
+				ASCLOG(App, Error, "Failed to initialize renderer.");
+				inst_->jobs_.wait(audio);
+				inst_->jobs_.wait(assets);
+				return false;
+			}
+		}
+		rendererTime = Profiler::Now() - rendererTime;
+		ASCLOG(App, Info, "Initialized OpenGL renderer.");
+
+		long long uploadTime = Profiler::Now();
+		{
+			ASC_PROFILE_SCOPE("App::Init uploads");
+			inst_->jobs_.wait(assets);
+			for (const std::string& t : conf.assets.textures) {
+				inst_->renderer_.getTexture(t);
+			}
+			for (const std::string& f : conf.assets.fonts) {
+				inst_->renderer_.getFont(f);
+			}
+		}
+		uploadTime = Profiler::Now() - uploadTime;
+		ASCLOG(App, Info, "Uploaded ", conf.assets.textures.size(), " textures and ",
+			conf.assets.fonts.size(), " fonts.");
 
-		inst_->audio_.init(conf.audio.volume);
+		inst_->jobs_.wait(audio);
 		ASCLOG(App, Info, "Initialized audio manager.");
+		if (conf.graphics.debugOutput) {
+			inst_->renderer_.setDebugOutput(true, conf.graphics.debugSeverity,
+				conf.graphics.debugTypes);
+		}
+		inst_->window_.capture().init();
+		if (conf.graphics.gpuCulling) {
+			inst_->renderer_.setGPUCulling(true);
+		}
+		if (conf.graphics.renderScale != 1.0f) {
+			inst_->renderer_.setRenderScale(conf.graphics.renderScale,
+				conf.graphics.renderScaleNearest, conf.graphics.nativeUI);
+		}
 
-		if (!inst_->renderer_.init(conf.graphics.clearColor)) {
-			ASCLOG(App, Error, "Failed to initialize renderer.");
-			return false;
+		double budget = conf.governor.budget;
+		if (budget <= 0.0 && inst_->pacer_.getTargetFPS() > 0.0) {
+			budget = 1.0 / inst_->pacer_.getTargetFPS();
+		}
+		inst_->governor_.init(budget, conf.governor.downFrames, conf.governor.upFrames,
+			conf.governor.upHeadroom);
+		inst_->governor_.setEnabled(conf.governor.enabled);
+		if (conf.governor.minRenderScale < conf.graphics.renderScale) {
+			float scale = conf.graphics.renderScale, minScale = conf.governor.minRenderScale;
+			bool nearest = conf.graphics.renderScaleNearest, nativeUI = conf.graphics.nativeUI;
+			unsigned int levels = 1 + (unsigned int)std::ceil((scale - minScale) / RENDER_SCALE_STEP);
+			inst_->governor_.addKnob("Render scale", levels, [=](unsigned int level) {
+				inst_->renderer_.setRenderScale(std::max(scale - level * RENDER_SCALE_STEP, minScale),
+					nearest, nativeUI);
+			});
 		}
-		ASCLOG(App, Info, "Initialized OpenGL renderer.");
 
 		inst_->targetUPS_ = conf.physics.targetUPS;
+		inst_->scheduler_.init(conf.physics.targetUPS);
 		inst_->maxUPF_ = conf.physics.maxUPF;
+		inst_->pipelined_ = conf.physics.pipelined;
+		inst_->traceKey_ = conf.log.traceKey;
+		inst_->traceFile_ = conf.log.traceFile;
+		inst_->traceFrames_ = conf.log.traceFrames;
+		inst_->idle_ = conf.window.idle;
+		inst_->idleTimeout_ = conf.window.idleTimeout;
+		inst_->redrawAt_ = 0.0;
+		inst_->updates_ = 0;
+		inst_->idleTime_ = 0.0;
+		inst_->keepLeft_ = conf.scenes.keepLeft;
+		inst_->keepBudget_ = conf.scenes.keepBudget;
 
 		inst_->scene_ = &conf.startScene;
+		ASCLOG(App, Info, "Initialized in ", (Profiler::Now() - initStart) / 1e6, " ms. Main thread: window ",
+			windowTime / 1e6, " ms, input ", inputTime / 1e6, " ms, renderer ", rendererTime / 1e6,
+			" ms, uploads ", uploadTime / 1e6, " ms. Workers: audio ", audioTime / 1e6, " ms, FreeType ",
+			loadersTime / 1e6, " ms, textures ", texturesTime / 1e6, " ms, fonts ", fontsTime / 1e6, " ms.");
 		return true;
 	}
 
@@ -70,10 +251,21 @@ namespace ASC {
 			== inst_->scenes_.end()) {
 			inst_->scenes_.push_back(&scene);
 		}
-		if (inst_->scene_ != 0 && inst_->scene_ != &scene) {
-			inst_->input_.removeLstr(*inst_->scene_);
-			inst_->scene_->leave(scene);
+		if (scene.loadState_ == Scene::LOADING) {
+			// Keep running the current scene until the new one has loaded.
+			inst_->next_ = &scene;
+			ASCLOG(App, Info, "Waiting for scene at ", &scene, " to load.");
+			return;
+		}
+		inst_->next_ = 0;
+		Scene* prev = inst_->scene_;
+		if (prev != 0 && prev != &scene) {
+			inst_->input_.removeLstr(*prev);
+			prev->leave(scene);
+			inst_->left_.remove(prev);
+			inst_->left_.push_back(prev);
 		}
+		inst_->left_.remove(&scene);
 		if (scene.initScene()) {
 			if (inst_->scene_ != 0) {
 				scene.enter(*inst_->scene_);
@@ -85,54 +277,350 @@ namespace ASC {
 			inst_->scene_ = &scene;
 		}
 		ASCLOG(App, Info, "Set to scene at ", &scene, ".");
+		EvictLeftScenes();
+		RequestRedraw();
+	}
+
+	void App::RequestRedraw(double delay) {
+		inst_->redrawAt_ = std::min(inst_->redrawAt_, glfwGetTime() + delay);
+	}
+
+	void App::PreloadScene(Scene& scene) {
+		if (scene.initialized_ || scene.loadState_ != Scene::UNLOADED) {
+			return;
+		}
+		if (std::find(inst_->scenes_.begin(), inst_->scenes_.end(), &scene)
+			== inst_->scenes_.end()) {
+			inst_->scenes_.push_back(&scene);
+		}
+		ASCLOG(App, Info, "Preloading scene at ", &scene, ".");
+		scene.loadState_ = Scene::LOADING;
+		scene.progress_ = 0.0f;
+		if (inst_->jobs_.getWorkers() == 0) {
+			// No worker would run the job until something waits on it.
+			scene.preloadScene();
+			return;
+		}
+		inst_->jobs_.submit([&scene]() {
+			scene.preloadScene();
+		}, &inst_->preloads_);
 	}
 
 	void App::Run() {
 		SetScene(*inst_->scene_);
+		if (inst_->pipelined_) {
+			RunPipelined();
+			return;
+		}
 
 		double start = glfwGetTime();
-		double now = glfwGetTime();
-		double elapsed = 0.0;
-		double dt = 0.0;
-		unsigned int updates = 0;
+		double acc = 0.0;
+		double work = 0.0;
+		double wait = 0.0;
+		bool drawn = true;
+		while (inst_->window_.update(drawn)) {
+			ASC_PROFILE_FRAME();
+			FramePacer::Clock::time_point frameStart = FramePacer::Clock::now();
+			if (inst_->input_.isReplayFinished()) {
+				break;
+			}
+			{
+				ASC_PROFILE_SCOPE("InputMgr::update");
+				inst_->input_.update(wait);
+			}
+			if (wait > 0.0) {
+				frameStart = FramePacer::Clock::now();
+			}
+			CheckTrace();
+			{
+				ASC_PROFILE_SCOPE("Scene::processInput");
+				if (!inst_->scene_->processInput()) {
+					break;
+				}
+			}
+			CheckNextScene();
+			{
+				ASC_PROFILE_SCOPE("TaskMgr::update");
+				inst_->tasks_.update(GetTaskTime());
+			}
+			wait = GetIdleWait();
+			drawn = wait <= 0.0;
+			if (!drawn) {
+				// Hold the update clock while idle rather than catching up on waking, but update
+				// once on waking so the scene reflects what woke it.
+				inst_->idleTime_ += glfwGetTime() - start;
+				start = glfwGetTime();
+				acc = 1.0;
+				continue;
+			}
+			inst_->governor_.frame(work, inst_->dropped_);
+
+			unsigned int ticks = StepClock(start, acc);
+			for (unsigned int i = 0; i < ticks; i++) {
+				{
+					ASC_PROFILE_SCOPE("Scene::update");
+					inst_->scene_->update(1.0f);
+				}
+				{
+					ASC_PROFILE_SCOPE("TickScheduler::tick");
+					inst_->scheduler_.tick();
+				}
+				{
+					ASC_PROFILE_SCOPE("Renderer::update");
+					inst_->renderer_.update(1.0f);
+				}
+			}
+
+			float alpha = (float)acc;
+			{
+				ASC_PROFILE_SCOPE("Renderer::begin");
+				inst_->renderer_.begin(alpha);
+			}
+			{
+				ASC_PROFILE_SCOPE("Scene::draw");
+				inst_->scene_->draw(alpha);
+			}
+			{
+				ASC_PROFILE_SCOPE("Renderer::end");
+				inst_->renderer_.end();
+			}
+
+			work = std::chrono::duration<double>(FramePacer::Clock::now() - frameStart).count();
+			ASC_PROFILE_SCOPE("FramePacer::wait");
+			inst_->pacer_.wait();
+		}
+	}
+
+	void App::RunPipelined() {
+		inst_->simBusy_ = false;
+		inst_->simStop_ = false;
+		inst_->sim_ = std::thread(&App::simulate, inst_);
+		ASCLOG(App, Info, "Started simulation thread.");
+
+		double start = glfwGetTime();
+		double acc = 0.0;
+		unsigned int ticks = 0;
+		double work = 0.0;
 		while (inst_->window_.update()) {
-			inst_->renderer_.begin();
-			inst_->scene_->draw();
-			inst_->renderer_.end();
+			ASC_PROFILE_FRAME();
+			FramePacer::Clock::time_point frameStart = FramePacer::Clock::now();
+			{
+				ASC_PROFILE_SCOPE("App::simulate wait");
+				std::unique_lock lock(inst_->simMtx_);
+				inst_->simCv_.wait(lock, []() {
+					return !inst_->simBusy_;
+				});
+			}
+			if (inst_->input_.isReplayFinished()) {
+				break;
+			}
 
-			inst_->input_.update();
-			if (!inst_->scene_->processInput()) {
+			{
+				ASC_PROFILE_SCOPE("InputMgr::update");
+				inst_->input_.update();
+			}
+			CheckTrace();
+			{
+				ASC_PROFILE_SCOPE("Scene::processInput");
+				if (!inst_->scene_->processInput()) {
+					break;
+				}
+			}
+			CheckNextScene();
+			{
+				ASC_PROFILE_SCOPE("TaskMgr::update");
+				inst_->tasks_.update(GetTaskTime());
+			}
+			inst_->governor_.frame(work, inst_->dropped_);
+
+			ticks = StepClock(start, acc);
+
+			{
+				ASC_PROFILE_SCOPE("Renderer::swapPackets");
+				inst_->renderer_.swapPackets();
+			}
+			{
+				std::scoped_lock lock(inst_->simMtx_);
+				inst_->simTicks_ = ticks;
+				inst_->simAlpha_ = (float)acc;
+				inst_->simBusy_ = true;
+			}
+			inst_->simCv_.notify_all();
+			{
+				ASC_PROFILE_SCOPE("Renderer::drawPacket");
+				inst_->renderer_.drawPacket();
+			}
+
+			work = std::chrono::duration<double>(FramePacer::Clock::now() - frameStart).count();
+			ASC_PROFILE_SCOPE("FramePacer::wait");
+			inst_->pacer_.wait();
+		}
+
+		{
+			std::unique_lock lock(inst_->simMtx_);
+			inst_->simCv_.wait(lock, []() {
+				return !inst_->simBusy_;
+			});
+			inst_->simStop_ = true;
+		}
+		inst_->simCv_.notify_all();
+		inst_->sim_.join();
+		ASCLOG(App, Info, "Stopped simulation thread.");
+	}
+
+	void App::simulate() {
+		ASC_PROFILE_THREAD("Simulation");
+		while (true) {
+			std::unique_lock lock(simMtx_);
+			simCv_.wait(lock, [this]() {
+				return simStop_ || simBusy_;
+			});
+			if (simStop_) {
 				break;
 			}
+			unsigned int ticks = simTicks_;
+			float alpha = simAlpha_;
+			lock.unlock();
 
-			now = glfwGetTime();
-			elapsed = now - start;
-			start = now;
-			dt = elapsed * inst_->targetUPS_;
-			while (dt > 1.0 && updates < inst_->maxUPF_) {
-				inst_->scene_->update(1.0f);
-				inst_->renderer_.update(1.0f);
-				dt -= 1.0;
-				updates++;
+			for (unsigned int i = 0; i < ticks; i++) {
+				{
+					ASC_PROFILE_SCOPE("Scene::update");
+					scene_->update(1.0f);
+				}
+				{
+					ASC_PROFILE_SCOPE("TickScheduler::tick");
+					scheduler_.tick();
+				}
+				{
+					ASC_PROFILE_SCOPE("Renderer::update");
+					renderer_.update(1.0f);
+				}
+			}
+			renderer_.beginPacket(alpha);
+			{
+				ASC_PROFILE_SCOPE("Scene::draw");
+				scene_->draw(alpha);
 			}
-			inst_->scene_->update((float)dt);
-			inst_->renderer_.update((float)dt);
-			updates = 0;
+			{
+				ASC_PROFILE_SCOPE("Renderer::endPacket");
+				renderer_.endPacket();
+			}
+
+			lock.lock();
+			simBusy_ = false;
+			lock.unlock();
+			simCv_.notify_all();
+		}
+	}
+
+	void App::CheckTrace() {
+		if (inst_->traceKey_ != 0 && inst_->input_.isKeyPressed(inst_->traceKey_)) {
+#ifdef ASC_PROFILE
+			Profiler::Dump(inst_->traceFile_, inst_->traceFrames_);
+#else
+			ASCLOG(App, Warning, "Profiling zones are compiled out, define ASC_PROFILE to write ",
+				inst_->traceFile_, ".");
+#endif
+		}
+	}
+
+	unsigned int App::StepClock(double& start, double& acc) {
+		unsigned int ticks = 0;
+		float alpha = 0.0f;
+		inst_->dropped_ = false;
+		if (inst_->input_.getReplayTicks(ticks, alpha)) {
+			acc = alpha;
+			inst_->updates_ += ticks;
+			return ticks;
+		}
+		double now = glfwGetTime();
+		acc += (now - start) * inst_->targetUPS_;
+		start = now;
+		while (acc >= 1.0 && ticks < inst_->maxUPF_) {
+			acc -= 1.0;
+			ticks++;
+		}
+		if (acc >= 1.0) {
+			// Drop the updates past the limit rather than spiraling to catch up.
+			acc -= std::floor(acc);
+			inst_->dropped_ = true;
+		}
+		inst_->input_.recordTicks(ticks, (float)acc);
+		inst_->updates_ += ticks;
+		return ticks;
+	}
+
+	double App::GetIdleWait() {
+		double now = glfwGetTime();
+		bool redraw = now >= inst_->redrawAt_;
+		if (redraw) {
+			inst_->redrawAt_ = HUGE_VAL;
+		}
+		if (!inst_->idle_ || inst_->input_.isReplaying() || inst_->input_.isRecording()) {
+			return 0.0;
+		}
+		if (inst_->input_.hadInput()) {
+			// Draw again once an update has run on the input too.
+			RequestRedraw(1.0 / inst_->targetUPS_);
+			return 0.0;
+		}
+		double wake = inst_->tasks_.getWakeTime() - GetTaskTime();
+		if (redraw || inst_->scene_->isAnimating() || inst_->next_ != 0 || wake <= 0.0) {
+			return 0.0;
+		}
+		return std::min({ inst_->idleTimeout_, inst_->redrawAt_ - now, wake });
+	}
+
+	double App::GetTaskTime() {
+		return inst_->updates_ / inst_->targetUPS_ + inst_->idleTime_;
+	}
 
-			Sleep(1);
+	void App::CheckNextScene() {
+		if (inst_->next_ != 0 && inst_->next_->loadState_ != Scene::LOADING) {
+			SetScene(*inst_->next_);
+		}
+	}
+
+	void App::EvictLeftScenes() {
+		size_t memory = 0;
+		for (Scene* scene : inst_->left_) {
+			memory += scene->getMemory();
+		}
+		while (!inst_->left_.empty() && (!inst_->keepLeft_ || memory > inst_->keepBudget_)) {
+			Scene* scene = inst_->left_.front();
+			inst_->left_.pop_front();
+			memory -= scene->getMemory();
+			if (scene == inst_->scene_) {
+				// The scene was left for one that failed to initialize, so is still targeted.
+				continue;
+			}
+			scene->destroyScene();
+			ASCLOG(App, Info, "Destroyed left scene at ", scene, ".");
 		}
 	}
 
 	void App::Destroy() {
+		inst_->jobs_.wait(inst_->preloads_);
+		inst_->tasks_.destroy();
 		inst_->scene_->leave(*inst_->scene_);
 		for (Scene* scene : inst_->scenes_) {
 			scene->destroyScene();
 		}
 		inst_->scenes_.clear();
+		inst_->left_.clear();
 		inst_->scene_ = 0;
+		inst_->next_ = 0;
+
+		inst_->governor_.destroy();
+		inst_->scheduler_.destroy();
+		inst_->pacer_.destroy();
+
+		ASCLOG(App, Info, "Destroying job system.");
+		inst_->jobs_.destroy();
 
 		ASCLOG(App, Info, "Destroying renderer.");
 		inst_->renderer_.destroy();
+		inst_->frameArena_.destroy();
 
 		ASCLOG(App, Info, "Destroying audio manager.");
 		inst_->audio_.destroy();
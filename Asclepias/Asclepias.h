@@ -7,26 +7,60 @@
 #ifndef ASC_ASCLEPIAS_H
 #define ASC_ASCLEPIAS_H
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <list>
+
 #include "Logging.h"
 #include "Graphics.h"
 #include "Windowing.h"
 #include "Input.h"
 #include "Audio.h"
 #include "UI.h"
+#include "Timing.h"
+#include "Jobs.h"
+#include "Tasks.h"
+#include "Memory.h"
+#include "Profiling.h"
 
 namespace ASC {
 	// Abstract scene interface for implementing Asclepias applciations.
 	class Scene : public InputLstr {
+	public:
+		/*
+		* @return The fraction of this scene's preload() done so far (0 to 1).
+		*/
+		inline float getProgress() const {
+			return progress_.load(std::memory_order_relaxed);
+		}
+		/*
+		* @return Whether this scene's assets are loaded so it can be entered without waiting.
+		*/
+		inline bool isLoaded() const {
+			return loadState_.load(std::memory_order_acquire) == LOADED;
+		}
+
 	protected:
 		friend class App;
 		friend class UIGroup;
 		
 		/*
-		* Call init() and flag this scene as initialized.
+		* Call preload() if it has not run, then init(), and flag this scene as initialized.
 		* @return Whether the scene is already initialized or could be.
 		*/
 		bool initScene();
 		/*
+		* Load this scene's assets that do not need the OpenGL context, such as with
+		* Renderer::preloadTexture() and AudioMgr::preloadEffect(). Runs on a worker thread when
+		* preloaded by App::PreloadScene(), so must not touch the window or OpenGL.
+		* @return Whether this scene's assets could be loaded.
+		*/
+		virtual bool preload() {
+			return true;
+		}
+		/*
 		* Initialize this scene's memory.
 		* @return Whether this scene could initialize.
 		*/
@@ -39,8 +73,10 @@ namespace ASC {
 		virtual void enter(Scene&) = 0;
 		/*
 		* Draw this scene's graphics.
+		* @param float alpha: The fraction of a fixed update elapsed since the last one (0 to 1), to
+		* interpolate between the previous and current state of entities by.
 		*/
-		virtual void draw() = 0;
+		virtual void draw(float) = 0;
 		/*
 		* Process user input to this scene.
 		* @return Whether user input is such that the App should keep running.
@@ -54,8 +90,8 @@ namespace ASC {
 		*/
 		virtual void cmptEvent(unsigned int, unsigned int, unsigned int) = 0;
 		/*
-		* Update this scene's logic and physics.
-		* @param float dt: Timestep since the last update.
+		* Update this scene's logic and physics by one fixed step.
+		* @param float dt: Timestep since the last update, always 1 update.
 		*/
 		virtual void update(float) = 0;
 		/*
@@ -69,18 +105,75 @@ namespace ASC {
 		*/
 		virtual void destroy() = 0;
 		/*
-		* Call destroy() and flag this scene as uninitialized.
+		* Call destroy() and flag this scene as uninitialized and unloaded.
 		*/
 		void destroyScene();
+		/*
+		* @return The memory in bytes this scene holds while initialized, counted against the
+		* budget for keeping left scenes.
+		*/
+		virtual size_t getMemory() const {
+			return 0;
+		}
+		/*
+		* @return Whether this scene is animating and must be updated and drawn every frame.
+		* While it is not, an app with idling enabled waits for input or a redraw request
+		* instead of updating and drawing it.
+		*/
+		virtual bool isAnimating() const {
+			return true;
+		}
+		/*
+		* Report how much of preload() is done, to show on a loading screen.
+		* @param float progress: The fraction of preload() done so far (0 to 1).
+		*/
+		inline void setProgress(float progress) {
+			progress_.store(progress, std::memory_order_relaxed);
+		}
+		/*
+		* Start a task owned by this scene, resumed each frame after processInput() and
+		* cancelled when this scene is destroyed.
+		* @param Task&& task: The task to start.
+		*/
+		void startTask(Task&&);
+		/*
+		* Register a system owned by this scene with the app's scheduler, run after update() at
+		* its own rate and removed when this scene is destroyed.
+		* @param const std::string& name: The name of the system in stats and logs.
+		* @param double rate: The rate in hertz to run at, 0 for every fixed update.
+		* @param const TickScheduler::System& update: Called with the system's timestep in fixed
+		* updates each time it is due.
+		* @param int phase: The fixed update within each interval to run on, negative to spread
+		* it from other systems.
+		* @return The ID of the system.
+		*/
+		unsigned int addSystem(const std::string&, double, const TickScheduler::System&, int = -1);
 
 	private:
+		// States of a scene's preload.
+		enum LoadState {
+			UNLOADED, LOADING, LOADED, FAILED
+		};
+
 		// Whether this scene's memory is initialized.
 		bool initialized_ = false;
+		// The state of this scene's preload, set from worker threads.
+		std::atomic<int> loadState_ = UNLOADED;
+		// The fraction of this scene's preload done so far.
+		std::atomic<float> progress_ = 0.0f;
+
+		/*
+		* Call preload() and record its outcome.
+		*/
+		void preloadScene();
 	};
 
 	// Entry point singleton for the Asclepias framework.
 	class App {
 	public:
+		// The render scale stepped by the governor's render scale knob.
+		static constexpr float RENDER_SCALE_STEP = 0.125f;
+
 		// Configuration structure for Apps.
 		struct Config {
 			// Configuration structure for App's log manager.
@@ -96,6 +189,15 @@ namespace ASC {
 				std::vector<std::string> fileNames = { "ASC.log" };
 				// The format for this log to print timestamps in.
 				std::string timestampFmt = "%Y.%m.%d.%H%M.%S";
+				// Whether to record profiling zones, only compiled in when ASC_PROFILE is defined.
+				bool profile = false;
+				// The key that dumps recent profiling zones to traceFile, 0 for none. Only logs a
+				// warning when ASC_PROFILE is not defined.
+				int traceKey = 0;
+				// The file path to write Chrome trace JSON to.
+				std::string traceFile = "trace.json";
+				// The number of recent frames to write to the trace.
+				unsigned int traceFrames = 120;
 			} log;
 			// Configuration structure for App's window manager.
 			struct Window {
@@ -105,24 +207,105 @@ namespace ASC {
 				std::string title = "Asclepias";
 				// Whether this window should open in fullscreen mode.
 				bool fullscreen = false;
+				// Whether buffer swaps should wait for vertical sync.
+				bool vsync = false;
+				// The frame rate to pace to, 0 for the refresh rate, negative for uncapped.
+				double targetFPS = 0.0;
+				// Whether to wait for input instead of updating and drawing while the scene is not
+				// animating, ignored in pipelined mode and while recording or replaying input.
+				bool idle = false;
+				// The longest time in seconds to wait for input while idle.
+				double idleTimeout = 0.5;
 			} window;
 			// Configuration structure for App's audio manager.
 			struct Audio {
 				// The initial global volume for audio.
 				float volume = 1.0f;
 			} audio;
+			// Configuration structure for App's input manager.
+			struct Input {
+				// The file path to record input events to, empty to not record.
+				std::string recordFile = "";
+				// The file path of a recording to replay instead of user input, empty for none.
+				std::string replayFile = "";
+				// Whether a replay hides the window and runs frames as fast as possible.
+				bool replayHeadless = false;
+			} input;
 			// Configuration structure for App's renderer.
 			struct Graphics {
 				// The color to clear the window to.
 				glm::vec3 clearColor = glm::vec3(0.0f, 0.0f, 0.0f);
+				// The glyph atlas memory in bytes to keep per font before evicting unused pages.
+				size_t glyphCacheSize = 16 * 1024 * 1024;
+				// The directory to cache rasterized fonts and linked shaders in, empty to disable caching.
+				std::string cacheDir = "Cache";
+				// Whether to cull sprites on the GPU when OpenGL 4.3 is available.
+				bool gpuCulling = false;
+				// The fraction of the window's resolution to draw scenes at before upscaling.
+				float renderScale = 1.0f;
+				// Whether to upscale with nearest filtering, for pixel art.
+				bool renderScaleNearest = false;
+				// Whether UI is drawn at the window's native resolution on top of the scaled scene.
+				bool nativeUI = true;
+				// Whether to create a debug context and log OpenGL debug messages.
+				bool debugOutput = false;
+				// The least severe OpenGL debug message to log.
+				GLenum debugSeverity = GL_DEBUG_SEVERITY_LOW;
+				// The OpenGL debug message types to log, empty to log all types.
+				std::vector<GLenum> debugTypes;
 			} graphics;
 			// Configuration structure for App's update loop timing.
 			struct Physics {
-				// Targeted number of updates per second.
+				// Number of fixed updates per second.
 				double targetUPS = 60.0;
-				// Maximum numbers of update() calls per frame.
+				// Maximum numbers of update() calls per frame, time past it is dropped.
 				unsigned int maxUPF = 10;
+				// Whether scenes are updated and drawn on a simulation thread while the previous
+				// frame is rendered, adding a frame of latency. Scenes must not use the window or
+				// OpenGL from update() or draw() in this mode.
+				bool pipelined = false;
 			} physics;
+			// Configuration structure for App's frame budget governor.
+			struct Governor {
+				// Whether quality knobs are stepped down under sustained overruns.
+				bool enabled = false;
+				// The frame time budget in seconds, 0 for the paced frame period.
+				double budget = 0.0;
+				// The number of frames averaged per decision to step down.
+				unsigned int downFrames = 30;
+				// The number of frames with headroom before stepping back up.
+				unsigned int upFrames = 180;
+				// The fraction of the budget frames must average under to have headroom.
+				double upHeadroom = 0.75;
+				// The lowest render scale the governor may step down to, the configured render
+				// scale to not govern it.
+				float minRenderScale = 1.0f;
+			} governor;
+			// Configuration structure for App's job system.
+			struct Jobs {
+				// Number of worker threads, 0 for one less than the hardware threads.
+				unsigned int workers = 0;
+			} jobs;
+			// Configuration structure for App's scene management.
+			struct Scenes {
+				// Whether scenes stay initialized after they are left so returning to them is
+				// instant. Left scenes are destroyed least recently left first past keepBudget.
+				bool keepLeft = true;
+				// The memory in bytes from Scene::getMemory() that kept left scenes may hold.
+				size_t keepBudget = (size_t)-1;
+			} scenes;
+			// Configuration structure for assets loaded by App::Init().
+			struct Assets {
+				// The PNG textures decoded while the window is created, then uploaded.
+				std::vector<std::string> textures;
+				// The TTF fonts read and rasterized while the window is created, then uploaded.
+				std::vector<std::string> fonts;
+			} assets;
+			// Configuration structure for App's transient memory.
+			struct Memory {
+				// The initial size in bytes of each frame arena buffer, grown to fit a frame's peak.
+				size_t frameArenaSize = 1024 * 1024;
+			} memory;
 			// The initial scene for this app.
 			Scene& startScene;
 
@@ -143,6 +326,17 @@ namespace ASC {
 		*/
 		static void SetScene(Scene&);
 		/*
+		* Start loading a scene's assets on the job system while the current scene keeps
+		* running. Setting a scene that is still loading switches to it once it has loaded.
+		* @param Scene& scene: The scene to preload.
+		*/
+		static void PreloadScene(Scene&);
+		/*
+		* Request the scene be drawn even if it is idle.
+		* @param double delay: The time in seconds from now to draw it at.
+		*/
+		static void RequestRedraw(double = 0.0);
+		/*
 		* Run this app's update loop.
 		*/
 		static void Run();
@@ -180,6 +374,42 @@ namespace ASC {
 		inline static Renderer& renderer() {
 			return inst_->renderer_;
 		}
+		/*
+		* @return This app's frame pacer.
+		*/
+		inline static FramePacer& pacer() {
+			return inst_->pacer_;
+		}
+		/*
+		* @return This app's frame budget governor.
+		*/
+		inline static FrameGovernor& governor() {
+			return inst_->governor_;
+		}
+		/*
+		* @return This app's job system.
+		*/
+		inline static JobMgr& jobs() {
+			return inst_->jobs_;
+		}
+		/*
+		* @return This app's task manager.
+		*/
+		inline static TaskMgr& tasks() {
+			return inst_->tasks_;
+		}
+		/*
+		* @return This app's scheduler for systems updated below the fixed update rate.
+		*/
+		inline static TickScheduler& scheduler() {
+			return inst_->scheduler_;
+		}
+		/*
+		* @return This app's arena for transient data, freed two frames after it is allocated.
+		*/
+		inline static FrameArena& frameArena() {
+			return inst_->frameArena_;
+		}
 
 	private:
 		// The singleton instance of this app.
@@ -194,14 +424,70 @@ namespace ASC {
 		AudioMgr audio_;
 		// This app's renderer.
 		Renderer renderer_;
+		// This app's frame pacer.
+		FramePacer pacer_;
+		// This app's job system.
+		JobMgr jobs_;
+		// This app's task manager.
+		TaskMgr tasks_;
+		// This app's scheduler for systems updated below the fixed update rate.
+		TickScheduler scheduler_;
+		// This app's arena for transient data.
+		FrameArena frameArena_;
+		// This app's frame budget governor.
+		FrameGovernor governor_;
+		// Whether the last frame dropped fixed updates past the limit.
+		bool dropped_ = false;
+		// Whether to wait for input while the scene is not animating.
+		bool idle_ = false;
+		// The longest time to wait for input while idle.
+		double idleTimeout_ = 0.0;
+		// The time the next redraw was requested for.
+		double redrawAt_ = 0.0;
+		// The number of fixed updates run since initialization.
+		unsigned long long updates_ = 0;
+		// The time in seconds skipped while idle, added to the task clock.
+		double idleTime_ = 0.0;
 		// Targeted updates per second for app.
 		double targetUPS_ = 0.0;
 		// Maximum number of updates per frame for app.
 		unsigned int maxUPF_ = 0;
+		// The key that dumps recent profiling zones, 0 for none.
+		int traceKey_ = 0;
+		// The file path to dump profiling zones to.
+		std::string traceFile_ = "";
+		// The number of recent frames to dump profiling zones for.
+		unsigned int traceFrames_ = 0;
+		// Whether scenes are updated and drawn on the simulation thread.
+		bool pipelined_ = false;
+		// The simulation thread of a pipelined app.
+		std::thread sim_;
+		// Mutex guarding the simulation thread's frame.
+		std::mutex simMtx_;
+		// Condition signalled when a simulation frame is started or finished.
+		std::condition_variable simCv_;
+		// Whether the simulation thread is updating and drawing a frame.
+		bool simBusy_ = false;
+		// Whether the simulation thread should stop.
+		bool simStop_ = false;
+		// The number of fixed updates in the simulation thread's frame.
+		unsigned int simTicks_ = 0;
+		// The interpolation alpha of the simulation thread's frame.
+		float simAlpha_ = 0.0f;
 		// The set of all scenes targeted by this app for its runtime.
 		std::vector<Scene*> scenes_;
 		// The currently targeted scene by this app.
 		Scene* scene_ = 0;
+		// The scene to switch to once it has loaded, 0 for none.
+		Scene* next_ = 0;
+		// The scenes left but kept initialized, least recently left first.
+		std::list<Scene*> left_;
+		// Whether left scenes stay initialized.
+		bool keepLeft_ = true;
+		// The memory left scenes may hold.
+		size_t keepBudget_ = 0;
+		// Counter of scene preloads in flight.
+		JobCounter preloads_;
 
 		/*
 		* Construct an App instance.
@@ -215,6 +501,45 @@ namespace ASC {
 		* Do not use the App's assignment operator.
 		*/
 		App& operator = (const App&) = delete;
+		/*
+		* Run this app's update loop with scenes updated and drawn into render packets on the
+		* simulation thread while the main thread renders the previous packet.
+		*/
+		static void RunPipelined();
+		/*
+		* Update and draw a frame of the scene each time one is started until stopped, run on the
+		* simulation thread.
+		*/
+		void simulate();
+		/*
+		* Request a profiling dump if the trace key was pressed.
+		*/
+		static void CheckTrace();
+		/*
+		* Advance the update clock by a frame, or take the frame's steps from a replay.
+		* @param double& start: The time the last frame's step was taken.
+		* @param double& acc: The fixed updates accumulated, left with the interpolation alpha.
+		* @return The number of fixed updates to run this frame.
+		*/
+		static unsigned int StepClock(double&, double&);
+		/*
+		* @return The time in seconds to wait for input before the next frame, 0 to update and
+		* draw it now.
+		*/
+		static double GetIdleWait();
+		/*
+		* @return The time in seconds tasks are resumed by, advanced by fixed updates so it is
+		* reproduced when replaying input, and by the time skipped while idle.
+		*/
+		static double GetTaskTime();
+		/*
+		* Switch to the pending scene if it has finished loading.
+		*/
+		static void CheckNextScene();
+		/*
+		* Destroy left scenes past the keep policy, least recently left first.
+		*/
+		static void EvictLeftScenes();
 	};
 }
 
@@ -20,12 +20,11 @@ namespace ASC {
 	}
 
 	bool AudioMgr::playEffect(const std::string& fileName) {
-		if (effects_.find(fileName) == effects_.end()) {
-			if (!loadEffect(fileName)) {
-				return false;
-			}
+		SoLoud::Wav* effect = getEffect(fileName);
+		if (effect == 0) {
+			return false;
 		}
-		audio_.play(effects_.at(fileName));
+		audio_.play(*effect);
 		return true;
 	}
 
@@ -41,13 +40,12 @@ namespace ASC {
 			ASCLOG(Audio, Info, "Resumed music track ", fileName, ".");
 		}
 		else {
-			if (effects_.find(fileName) == effects_.end()) {
-				if (!loadEffect(fileName)) {
-					return false;
-				}
+			SoLoud::Wav* track = getEffect(fileName);
+			if (track == 0) {
+				return false;
 			}
 			stopMusic();
-			music_ = audio_.playBackground(effects_.at(fileName));
+			music_ = audio_.playBackground(*track);
 			audio_.setLooping(music_, true);
 			ASCLOG(Audio, Info, "Playing music track ", fileName, ".");
 		}
@@ -78,10 +76,13 @@ namespace ASC {
 	}
 
 	void AudioMgr::destroy() {
-		effects_.clear();
+		audio_.stopAll();
+		{
+			std::scoped_lock lock(effectsMtx_);
+			effects_.clear();
+		}
 		music_ = 0;
 		musicPaused_ = false;
-		audio_.stopAll();
 		audio_.deinit();
 		ASCLOG(Audio, Info, "Destroyed SoLoud library.");
 	}
@@ -96,13 +97,35 @@ namespace ASC {
 		audio_.setGlobalVolume(volume);
 	}
 
-	bool AudioMgr::loadEffect(const std::string& fileName) {
+	SoLoud::Wav* AudioMgr::getEffect(const std::string& fileName) {
+		{
+			std::scoped_lock lock(effectsMtx_);
+			std::map<std::string, std::unique_ptr<SoLoud::Wav>>::iterator it = effects_.find(fileName);
+			if (it != effects_.end()) {
+				return it->second.get();
+			}
+		}
+		std::unique_ptr<SoLoud::Wav> effect = loadEffect(fileName);
+		if (!effect) {
+			return 0;
+		}
+		std::scoped_lock lock(effectsMtx_);
+		// Another thread may have loaded the same file meanwhile, keep the first one.
+		std::unique_ptr<SoLoud::Wav>& entry = effects_[fileName];
+		if (!entry) {
+			entry = std::move(effect);
+		}
+		return entry.get();
+	}
+
+	std::unique_ptr<SoLoud::Wav> AudioMgr::loadEffect(const std::string& fileName) {
+		ASC_PROFILE_SCOPE("AudioMgr::loadEffect");
 		ASCLOG(Audio, Info, "Loading sound effect ", fileName, ".");
-		effects_[fileName] = SoLoud::Wav();
-		if (effects_[fileName].load(fileName.c_str()) != SoLoud::SO_NO_ERROR) {
+		std::unique_ptr<SoLoud::Wav> effect = std::make_unique<SoLoud::Wav>();
+		if (effect->load(fileName.c_str()) != SoLoud::SO_NO_ERROR) {
 			ASCLOG(Audio, Warning, "Failed to load sound effect ", fileName, ".");
-			return false;
+			return 0;
 		}
-		return true;
+		return effect;
 	}
 }
\ No newline at end of file
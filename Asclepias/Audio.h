@@ -11,6 +11,8 @@
 #include <SoLoud/soloud_wav.h>
 #include <map>
 #include <string>
+#include <memory>
+#include <mutex>
 
 namespace ASC {
 	// App utility for loading and playing sound effects and background music.
@@ -29,6 +31,14 @@ namespace ASC {
 		*/
 		bool playEffect(const std::string&);
 		/*
+		* Load a sound effect or music track ahead of playing it, may be called from any thread.
+		* @param const std::string& fileName: The file path to the WAV file.
+		* @return Whether the file could be loaded into memory.
+		*/
+		inline bool preloadEffect(const std::string& fileName) {
+			return getEffect(fileName) != 0;
+		}
+		/*
 		* Play a new or the current music track.
 		* @param const std::string& fileName: The file path to the WAV music, empty string
 		* to resume current track.
@@ -69,18 +79,26 @@ namespace ASC {
 		// SoLoud library instance used to load and play WAV files.
 		SoLoud::Soloud audio_;
 		// Set of sound effects and music tracks loaded into memory.
-		std::map<std::string, SoLoud::Wav> effects_;
+		std::map<std::string, std::unique_ptr<SoLoud::Wav>> effects_;
+		// Mutex guarding the set of sound effects, which may be preloaded from other threads.
+		std::mutex effectsMtx_;
 		// The currently playing music track.
 		SoLoud::handle music_ = 0;
 		// Whether the music track is currently paused.
 		bool musicPaused_ = false;
 
+		/*
+		* Retrieve a loaded sound effect, loading it first if needed.
+		* @param const std::string& fileName: The path to the WAV file.
+		* @return The loaded sound effect, 0 if it could not be loaded.
+		*/
+		SoLoud::Wav* getEffect(const std::string&);
 		/*
 		* Load a WAV file via the SoLoud library.
 		* @param const std::string& fileName: The path to the WAV file.
-		* @return Whether the file could be loaded into memory.
+		* @return The loaded sound effect, empty if it could not be loaded.
 		*/
-		bool loadEffect(const std::string&);
+		std::unique_ptr<SoLoud::Wav> loadEffect(const std::string&);
 	};
 }
 
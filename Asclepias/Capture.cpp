@@ -0,0 +1,347 @@
+/*
+* File:		Capture.cpp
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.07
+*/
+
+#include "Asclepias.h"
+
+namespace ASC {
+	// Define CaptureMgr functions.
+
+	void CaptureMgr::init() {
+		for (Slot& s : slots_) {
+			glGenBuffers(1, &s.buffer);
+		}
+		next_ = 0;
+		dropped_ = 0;
+		queuedFrames_ = 0;
+		failures_ = 0;
+		loggedFailures_ = 0;
+		stop_ = false;
+		encoder_ = std::thread(&CaptureMgr::encode, this);
+		ASCLOG(Capture, Info, "Started capture encoder thread.");
+	}
+
+	void CaptureMgr::update(const glm::ivec2& dims) {
+		for (unsigned int i = 0; i < RING_SIZE; i++) {
+			Slot& s = slots_[(next_ + i) % RING_SIZE];
+			if (s.fence != 0 && glClientWaitSync(s.fence, 0, 0) != GL_TIMEOUT_EXPIRED) {
+				retire(s);
+			}
+		}
+		endVideo();
+		if (failures_ > loggedFailures_) {
+			ASCLOG(Capture, Warning, "Failed to write ", failures_ - loggedFailures_,
+				" captured frames.");
+			loggedFailures_ = failures_;
+		}
+		if (recording_ && videoDims_ != glm::ivec2() && dims != videoDims_) {
+			ASCLOG(Capture, Warning, "Window resized to ", dims.x, "x", dims.y, " from ", videoDims_.x,
+				"x", videoDims_.y, " while recording.");
+			stopRecording();
+		}
+		if (screenshots_.empty() && !recording_) {
+			return;
+		}
+		Slot& s = slots_[next_];
+		if (s.fence != 0) {
+			dropped_++;
+			return;
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, s.buffer);
+		if (s.dims != dims) {
+			glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)dims.x * dims.y * 4, 0, GL_STREAM_READ);
+			s.dims = dims;
+		}
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadBuffer(GL_BACK);
+		glReadPixels(0, 0, dims.x, dims.y, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		s.screenshots.swap(screenshots_);
+		screenshots_.clear();
+		s.video = recording_;
+		if (recording_) {
+			videoDims_ = dims;
+		}
+		next_ = (next_ + 1) % RING_SIZE;
+	}
+
+	void CaptureMgr::destroy() {
+		stopRecording();
+		glFinish();
+		for (unsigned int i = 0; i < RING_SIZE; i++) {
+			Slot& s = slots_[(next_ + i) % RING_SIZE];
+			if (s.fence != 0) {
+				retire(s);
+			}
+		}
+		endVideo();
+		for (Slot& s : slots_) {
+			glDeleteBuffers(1, &s.buffer);
+			s.buffer = 0;
+			s.dims = glm::ivec2();
+		}
+		screenshots_.clear();
+		{
+			std::scoped_lock lock(mtx_);
+			stop_ = true;
+		}
+		cv_.notify_one();
+		if (encoder_.joinable()) {
+			encoder_.join();
+		}
+		ASCLOG(Capture, Info, "Stopped capture encoder thread, dropped ", dropped_, " frames.");
+	}
+
+	void CaptureMgr::screenshot(const std::string& fileName) {
+		screenshots_.push_back(fileName);
+	}
+
+	bool CaptureMgr::startRecording(const std::string& fileName, CaptureFormat format,
+		unsigned int fps) {
+		if (recording_ || ending_) {
+			ASCLOG(Capture, Warning, "Already recording to ", videoFile_, ".");
+			return false;
+		}
+		recording_ = true;
+		videoFile_ = fileName;
+		videoFormat_ = format;
+		videoFPS_ = fps;
+		videoDims_ = glm::ivec2();
+		ASCLOG(Capture, Info, "Started recording to ", fileName, ".");
+		return true;
+	}
+
+	void CaptureMgr::stopRecording() {
+		if (!recording_) {
+			return;
+		}
+		recording_ = false;
+		ending_ = true;
+		endVideo();
+		ASCLOG(Capture, Info, "Stopped recording to ", videoFile_, ".");
+	}
+
+	void CaptureMgr::endVideo() {
+		if (!ending_) {
+			return;
+		}
+		for (const Slot& s : slots_) {
+			if (s.fence != 0 && s.video) {
+				return;
+			}
+		}
+		ending_ = false;
+		Job j;
+		j.kind = Job::VIDEO_END;
+		j.fileName = videoFile_;
+		push(std::move(j));
+	}
+
+	void CaptureMgr::retire(Slot& s) {
+		glDeleteSync(s.fence);
+		s.fence = 0;
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, s.buffer);
+		size_t size = (size_t)s.dims.x * s.dims.y * 4;
+		const unsigned char* data = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+			size, GL_MAP_READ_BIT);
+		if (data != 0) {
+			for (const std::string& f : s.screenshots) {
+				Job j;
+				j.kind = Job::SCREENSHOT;
+				j.fileName = f;
+				j.dims = s.dims;
+				j.pixels.assign(data, data + size);
+				push(std::move(j));
+			}
+			if (s.video) {
+				Job j;
+				j.kind = Job::VIDEO_FRAME;
+				j.fileName = videoFile_;
+				j.format = videoFormat_;
+				j.fps = videoFPS_;
+				j.dims = s.dims;
+				j.pixels.assign(data, data + size);
+				if (!push(std::move(j))) {
+					dropped_++;
+				}
+			}
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		s.screenshots.clear();
+		s.video = false;
+	}
+
+	bool CaptureMgr::push(Job&& job) {
+		{
+			std::scoped_lock lock(mtx_);
+			if (job.kind == Job::VIDEO_FRAME) {
+				if (queuedFrames_ >= MAX_QUEUED_FRAMES) {
+					return false;
+				}
+				queuedFrames_++;
+			}
+			jobs_.push_back(std::move(job));
+		}
+		cv_.notify_one();
+		return true;
+	}
+
+	void CaptureMgr::encode() {
+		ASC_PROFILE_THREAD("Capture encoder");
+		while (true) {
+			std::unique_lock lock(mtx_);
+			cv_.wait(lock, [this]() {
+				return stop_ || !jobs_.empty();
+			});
+			if (jobs_.empty()) {
+				break;
+			}
+			Job j = std::move(jobs_.front());
+			jobs_.pop_front();
+			if (j.kind == Job::VIDEO_FRAME) {
+				queuedFrames_--;
+			}
+			lock.unlock();
+			ASC_PROFILE_SCOPE("CaptureMgr::encode");
+			bool written = true;
+			if (j.kind == Job::SCREENSHOT) {
+				written = writePNG(j);
+			}
+			else if (j.kind == Job::VIDEO_FRAME) {
+				written = writeFrame(j);
+			}
+			else if (video_.is_open()) {
+				video_.close();
+			}
+			if (!written) {
+				failures_++;
+			}
+		}
+		if (video_.is_open()) {
+			video_.close();
+		}
+	}
+
+	// Helpers for writing PNG chunks.
+
+	static unsigned int Crc32(const unsigned char* data, size_t size, unsigned int crc) {
+		static unsigned int table[256] = {};
+		if (table[1] == 0) {
+			for (unsigned int n = 0; n < 256; n++) {
+				unsigned int c = n;
+				for (int k = 0; k < 8; k++) {
+					c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				}
+				table[n] = c;
+			}
+		}
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++) {
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+
+	static void PutU32(std::vector<unsigned char>& out, unsigned int v) {
+		out.push_back((unsigned char)(v >> 24));
+		out.push_back((unsigned char)(v >> 16));
+		out.push_back((unsigned char)(v >> 8));
+		out.push_back((unsigned char)v);
+	}
+
+	static void PutChunk(std::ofstream& file, const char* type,
+		const std::vector<unsigned char>& data) {
+		std::vector<unsigned char> chunk;
+		PutU32(chunk, (unsigned int)data.size());
+		chunk.insert(chunk.end(), type, type + 4);
+		chunk.insert(chunk.end(), data.begin(), data.end());
+		PutU32(chunk, Crc32(&chunk[4], chunk.size() - 4, 0));
+		file.write((const char*)chunk.data(), chunk.size());
+	}
+
+	bool CaptureMgr::writePNG(const Job& j) {
+		std::ofstream file(j.fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+		const unsigned char sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		file.write((const char*)sig, sizeof(sig));
+		std::vector<unsigned char> header;
+		PutU32(header, (unsigned int)j.dims.x);
+		PutU32(header, (unsigned int)j.dims.y);
+		header.insert(header.end(), { 8, 6, 0, 0, 0 });
+		PutChunk(file, "IHDR", header);
+		// Filter type 0 scanlines, top row first.
+		size_t stride = (size_t)j.dims.x * 4;
+		std::vector<unsigned char> raw;
+		raw.reserve((stride + 1) * j.dims.y);
+		for (int y = j.dims.y - 1; y >= 0; y--) {
+			raw.push_back(0);
+			raw.insert(raw.end(), &j.pixels[y * stride], &j.pixels[y * stride] + stride);
+		}
+		// Zlib stream of stored deflate blocks.
+		std::vector<unsigned char> z = { 0x78, 0x01 };
+		size_t pos = 0;
+		do {
+			size_t len = std::min<size_t>(raw.size() - pos, 65535);
+			z.push_back(pos + len == raw.size() ? 1 : 0);
+			z.push_back((unsigned char)len);
+			z.push_back((unsigned char)(len >> 8));
+			z.push_back((unsigned char)~len);
+			z.push_back((unsigned char)(~len >> 8));
+			z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+			pos += len;
+		} while (pos < raw.size());
+		unsigned int a = 1, b = 0;
+		for (unsigned char c : raw) {
+			a = (a + c) % 65521;
+			b = (b + a) % 65521;
+		}
+		PutU32(z, (b << 16) | a);
+		PutChunk(file, "IDAT", z);
+		PutChunk(file, "IEND", {});
+		return file.good();
+	}
+
+	bool CaptureMgr::writeFrame(const Job& j) {
+		if (!video_.is_open()) {
+			video_.open(j.fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!video_.is_open()) {
+				return false;
+			}
+			if (j.format == ASC_CAPTURE_Y4M) {
+				video_ << "YUV4MPEG2 W" << j.dims.x << " H" << j.dims.y << " F" << j.fps
+					<< ":1 Ip A1:1 C444\n";
+			}
+		}
+		size_t stride = (size_t)j.dims.x * 4;
+		if (j.format == ASC_CAPTURE_RAW) {
+			for (int y = j.dims.y - 1; y >= 0; y--) {
+				video_.write((const char*)&j.pixels[y * stride], stride);
+			}
+			return video_.good();
+		}
+		size_t plane = (size_t)j.dims.x * j.dims.y;
+		std::vector<unsigned char> yuv(plane * 3);
+		size_t i = 0;
+		for (int y = j.dims.y - 1; y >= 0; y--) {
+			const unsigned char* row = &j.pixels[y * stride];
+			for (int x = 0; x < j.dims.x; x++, i++) {
+				float r = row[x * 4], g = row[x * 4 + 1], b = row[x * 4 + 2];
+				yuv[i] = (unsigned char)glm::clamp(16.0f + 0.257f * r + 0.504f * g + 0.098f * b,
+					0.0f, 255.0f);
+				yuv[plane + i] = (unsigned char)glm::clamp(128.0f - 0.148f * r - 0.291f * g
+					+ 0.439f * b, 0.0f, 255.0f);
+				yuv[2 * plane + i] = (unsigned char)glm::clamp(128.0f + 0.439f * r - 0.368f * g
+					- 0.071f * b, 0.0f, 255.0f);
+			}
+		}
+		video_ << "FRAME\n";
+		video_.write((const char*)yuv.data(), yuv.size());
+		return video_.good();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+/*
+* File:		Capture.h
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.07
+*/
+
+#ifndef ASC_CAPTURE_H
+#define ASC_CAPTURE_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace ASC {
+	// Enumeration of video capture formats.
+	enum CaptureFormat {
+		ASC_CAPTURE_Y4M, ASC_CAPTURE_RAW,
+	};
+
+	// Utility for reading back the window's frames without stalling and encoding them to files.
+	class CaptureMgr {
+	public:
+		// Number of pixel buffer objects frames are read back through.
+		static const unsigned int RING_SIZE = 3;
+		// Number of video frames waiting for the encoder thread before new ones are dropped.
+		static const unsigned int MAX_QUEUED_FRAMES = 8;
+
+		/*
+		* Initialize this capture manager's memory and start its encoder thread.
+		*/
+		void init();
+		/*
+		* Queue a readback of the frame about to be presented and hand completed readbacks from
+		* previous frames to the encoder thread, called before the window's buffers are swapped.
+		* @param const glm::ivec2& dims: The dimensions of the frame to read back (w, h).
+		*/
+		void update(const glm::ivec2&);
+		/*
+		* Finish the GPU's queued readbacks, wait for queued encodes to finish and stop the
+		* encoder thread.
+		*/
+		void destroy();
+		/*
+		* Capture the next presented frame to a PNG file.
+		* @param const std::string& fileName: The file path to write the screenshot to.
+		*/
+		void screenshot(const std::string&);
+		/*
+		* Start capturing every presented frame to a video file.
+		* @param const std::string& fileName: The file path to write the video to.
+		* @param CaptureFormat format: The format to write, Y4M (4:4:4) or raw RGBA frames.
+		* @param unsigned int fps: The frame rate to store in the Y4M header.
+		* @return Whether no video was already being recorded or finished.
+		*/
+		bool startRecording(const std::string&, CaptureFormat = ASC_CAPTURE_Y4M, unsigned int = 60);
+		/*
+		* Stop capturing frames to the current video file, which is closed once the frames still
+		* being read back are encoded. Recording also stops if the window is resized.
+		*/
+		void stopRecording();
+		/*
+		* @return Whether frames are being captured to a video file.
+		*/
+		inline bool isRecording() const {
+			return recording_;
+		}
+		/*
+		* @return The number of frames not captured because every pixel buffer was in flight or
+		* the encoder thread fell behind.
+		*/
+		inline unsigned int getDroppedFrames() const {
+			return dropped_;
+		}
+
+	private:
+		// Pixel buffer object a frame is read back into.
+		struct Slot {
+			// The OpenGL pixel buffer object ID.
+			GLuint buffer = 0;
+			// The fence signalled when the readback completes, 0 if this slot is free.
+			GLsync fence = 0;
+			// The dimensions of the frame read back into this slot.
+			glm::ivec2 dims = glm::ivec2();
+			// The screenshot files to write the frame to once read back.
+			std::vector<std::string> screenshots;
+			// Whether the frame is part of the current video.
+			bool video = false;
+		};
+		// Frame to encode on the encoder thread.
+		struct Job {
+			// The kind of file to encode the frame to.
+			enum Kind {
+				SCREENSHOT, VIDEO_FRAME, VIDEO_END,
+			} kind = SCREENSHOT;
+			// The file to write to.
+			std::string fileName = "";
+			// The video format to write in.
+			CaptureFormat format = ASC_CAPTURE_Y4M;
+			// The frame rate of the video.
+			unsigned int fps = 0;
+			// The dimensions of the frame (w, h).
+			glm::ivec2 dims = glm::ivec2();
+			// The frame's RGBA pixels, bottom row first.
+			std::vector<unsigned char> pixels;
+		};
+
+		// The ring of pixel buffers frames are read back through.
+		Slot slots_[RING_SIZE];
+		// The next slot to read a frame back into.
+		unsigned int next_ = 0;
+		// The screenshot files requested for the next frame.
+		std::vector<std::string> screenshots_;
+		// Whether frames are being recorded.
+		bool recording_ = false;
+		// The file the current video is written to.
+		std::string videoFile_ = "";
+		// The format of the current video.
+		CaptureFormat videoFormat_ = ASC_CAPTURE_Y4M;
+		// The frame rate of the current video.
+		unsigned int videoFPS_ = 60;
+		// The dimensions of the current video's frames, 0 until its first frame.
+		glm::ivec2 videoDims_ = glm::ivec2();
+		// Whether the stopped video is closed once its frames in flight are retired.
+		bool ending_ = false;
+		// The number of frames dropped because every slot was in flight or the encoder lagged.
+		unsigned int dropped_ = 0;
+		// Jobs waiting for the encoder thread.
+		std::deque<Job> jobs_;
+		// The number of video frame jobs waiting for the encoder thread.
+		unsigned int queuedFrames_ = 0;
+		// Mutex guarding the encoder thread's jobs.
+		std::mutex mtx_;
+		// Condition signalled when jobs are added or the encoder thread should stop.
+		std::condition_variable cv_;
+		// Whether the encoder thread should stop once its jobs are done.
+		bool stop_ = false;
+		// The number of jobs the encoder thread failed to write.
+		std::atomic<unsigned int> failures_ = 0;
+		// The number of failures already logged.
+		unsigned int loggedFailures_ = 0;
+		// The background encoder thread.
+		std::thread encoder_;
+		// The encoder thread's open video file.
+		std::ofstream video_;
+
+		/*
+		* Map a slot's completed readback and queue its jobs for the encoder thread.
+		* @param Slot& slot: The slot to retire.
+		*/
+		void retire(Slot&);
+		/*
+		* Queue a job for the encoder thread.
+		* @param Job&& job: The job to queue.
+		* @return Whether the job was queued, false for video frames while the queue is full.
+		*/
+		bool push(Job&&);
+		/*
+		* Queue the end of the stopped video once none of its frames are in flight.
+		*/
+		void endVideo();
+		/*
+		* Encode jobs until stopped, run on the encoder thread.
+		*/
+		void encode();
+		/*
+		* Write a frame to a PNG file with stored deflate blocks.
+		* @param const Job& job: The screenshot job to write.
+		* @return Whether the file could be written.
+		*/
+		bool writePNG(const Job&);
+		/*
+		* Append a frame to the open video file, opening it first if required.
+		* @param const Job& job: The video frame job to write.
+		* @return Whether the frame could be written.
+		*/
+		bool writeFrame(const Job&);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -4,41 +4,89 @@
 * Created:	2023.03.07
 */
 
+#include <fstream>
+
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "Asclepias.h"
 
 namespace ASC {
+	// Define Entity functions.
+
+	glm::vec3 Entity::getLerpPos(float alpha) const {
+		if (pos != tickEndPos_ || tick_ + 1 != App::renderer().getTicks()) {
+			return pos;
+		}
+		return glm::mix(tickStartPos_, pos, alpha);
+	}
+
 	// Define Camera functions.
 
 	void Camera::operator = (const Camera& c) {
 		pos = c.pos;
 		vel = c.vel;
 		scale = c.scale;
+		viewDims = c.viewDims;
 		prevPos_ = c.prevPos_;
 		prevScale_ = c.prevScale_;
 		prevWindowDims_ = c.prevWindowDims_;
-		updateMatrix();
+		tickStartPos_ = c.tickStartPos_;
+		tickEndPos_ = c.tickEndPos_;
+		tickStartScale_ = c.tickStartScale_;
+		tickEndScale_ = c.tickEndScale_;
+		tick_ = c.tick_;
+		updateMatrix(pos, scale);
 	}
 
 	void Camera::init() {
-		updateMatrix();
+		tickStartPos_ = pos;
+		tickEndPos_ = pos;
+		tickStartScale_ = scale;
+		tickEndScale_ = scale;
+		updateMatrix(pos, scale);
 	}
 
 	void Camera::update(float dt) {
+		tickStartPos_ = pos;
+		tickStartScale_ = scale;
 		pos.x += dt * vel.x;
 		pos.y += dt * vel.y;
 		scale += dt * scaleVel;
-		if (pos != prevPos_ || scale != prevScale_ || prevWindowDims_ != App::window().getDims()) {
-			updateMatrix();
+		tickEndPos_ = pos;
+		tickEndScale_ = scale;
+		tick_ = App::renderer().getTicks();
+		if (pos != prevPos_ || scale != prevScale_ || prevWindowDims_ != getViewDims()) {
+			updateMatrix(pos, scale);
 			prevPos_ = pos;
 			prevScale_ = scale;
-			prevWindowDims_ = App::window().getDims();
+			prevWindowDims_ = getViewDims();
+		}
+	}
+
+	glm::ivec2 Camera::getViewDims() const {
+		if (viewDims.x > 0 && viewDims.y > 0) {
+			return viewDims;
+		}
+		return App::window().getDims();
+	}
+
+	glm::vec4 Camera::getBounds() const {
+		glm::vec2 vd((float)getViewDims().x, (float)getViewDims().y);
+		glm::vec2 half = vd / (2.0f * scale);
+		return glm::vec4(pos.x - half.x, pos.y - half.y, 2.0f * half.x, 2.0f * half.y);
+	}
+
+	void Camera::interpolate(float alpha) {
+		float s = scale;
+		if (scale == tickEndScale_ && tick_ + 1 == App::renderer().getTicks()) {
+			s = glm::mix(tickStartScale_, scale, alpha);
 		}
+		updateMatrix(getLerpPos(alpha), s);
+		prevWindowDims_ = getViewDims();
 	}
 
-	void Camera::updateMatrix() {
-		glm::vec2 wd((float)App::window().getDims().x, (float)App::window().getDims().y);
+	void Camera::updateMatrix(const glm::vec3& pos, float scale) {
+		glm::vec2 wd((float)getViewDims().x, (float)getViewDims().y);
 		orthoMatrix_ = glm::ortho(0.0f, wd.x, 0.0f, wd.y);
 		matrix_ = glm::translate(orthoMatrix_,
 			glm::vec3(-pos.x + wd.x / 2.0f, -pos.y + wd.y / 2.0f, 0.0f));
@@ -56,13 +104,22 @@ namespace ASC {
 		this->texture = texture;
 		this->textureRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
 		this->color = glm::vec3(0.0f, 0.0f, 0.0f);
+		tickStartPos_ = pos;
+		tickEndPos_ = pos;
+		tickStartRot_ = rot;
+		tickEndRot_ = rot;
 		vertices_.clear();
 	}
 
 	void Sprite::update(float dt) {
+		tickStartPos_ = pos;
+		tickStartRot_ = rot;
 		pos.x += dt * vel.x;
 		pos.y += dt * vel.y;
 		rot += dt * rotVel;
+		tickEndPos_ = pos;
+		tickEndRot_ = rot;
+		tick_ = App::renderer().getTicks();
 	}
 
 	void Sprite::destroy() {
@@ -73,6 +130,10 @@ namespace ASC {
 		dims = glm::vec2();
 		texture = 0;
 		textureRect = glm::vec4();
+		tickStartPos_ = glm::vec3();
+		tickEndPos_ = glm::vec3();
+		tickStartRot_ = 0.0f;
+		tickEndRot_ = 0.0f;
 		vertices_.clear();
 	}
 
@@ -86,16 +147,25 @@ namespace ASC {
 		return true;
 	}
 
-	void Sprite::draw() {
-		glm::vec3 bl(pos.x, pos.y, pos.z);
-		glm::vec3 br(pos.x + dims.x, pos.y, pos.z);
-		glm::vec3 tl(pos.x + dims.x, pos.y + dims.y, pos.z);
-		glm::vec3 tr(pos.x, pos.y + dims.y, pos.z);
-		if ((int)rot % 360 != 0) {
-			bl = rotate(bl);
-			br = rotate(br);
-			tl = rotate(tl);
-			tr = rotate(tr);
+	float Sprite::getLerpRot(float alpha) const {
+		if (rot != tickEndRot_ || pos != tickEndPos_ || tick_ + 1 != App::renderer().getTicks()) {
+			return rot;
+		}
+		return glm::mix(tickStartRot_, rot, alpha);
+	}
+
+	void Sprite::draw(float alpha) {
+		glm::vec3 p = getLerpPos(alpha);
+		float r = getLerpRot(alpha);
+		glm::vec3 bl(p.x, p.y, p.z);
+		glm::vec3 br(p.x + dims.x, p.y, p.z);
+		glm::vec3 tl(p.x + dims.x, p.y + dims.y, p.z);
+		glm::vec3 tr(p.x, p.y + dims.y, p.z);
+		if ((int)r % 360 != 0) {
+			bl = rotate(bl, p, r);
+			br = rotate(br, p, r);
+			tl = rotate(tl, p, r);
+			tr = rotate(tr, p, r);
 		}
 		if (!reflectH && !reflectV) {
 			vertices_ = {
@@ -165,9 +235,9 @@ namespace ASC {
 
 #define PI 3.1415926f
 
-	glm::vec3 Sprite::rotate(const glm::vec3& p) {
-		float a = (PI / 180.0f) * rot;
-		glm::vec2 c = glm::vec2(pos.x, pos.y) + (dims / 2.0f);
+	glm::vec3 Sprite::rotate(const glm::vec3& p, const glm::vec3& at, float deg) {
+		float a = (PI / 180.0f) * deg;
+		glm::vec2 c = glm::vec2(at.x, at.y) + (dims / 2.0f);
 		float rx = cos(a) * (p.x - c.x) - sin(a) * (p.y - c.y) + c.x;
 		float ry = sin(a) * (p.x - c.x) + cos(a) * (p.y - c.y) + c.y;
 		return glm::vec3(rx, ry, p.z);
@@ -189,9 +259,14 @@ namespace ASC {
 	}
 
 	void Animation::update(float dt) {
+		tickStartPos_ = pos;
+		tickStartRot_ = rot;
 		pos.x += dt * vel.x;
 		pos.y += dt * vel.y;
 		rot += dt * rotVel;
+		tickEndPos_ = pos;
+		tickEndRot_ = rot;
+		tick_ = App::renderer().getTicks();
 		if (!playing_) {
 			return;
 		}
@@ -220,9 +295,606 @@ namespace ASC {
 		dims = glm::vec2();
 		texture = 0;
 		textureRect = glm::vec4();
+		tickStartPos_ = glm::vec3();
+		tickEndPos_ = glm::vec3();
+		tickStartRot_ = 0.0f;
+		tickEndRot_ = 0.0f;
 		frameTime_ = 0.0f;
 		playing_ = false;
 		timer_ = 0.0f;
 		frame_ = 0;
 	}
+
+	// Define UTF-8 functions.
+
+	unsigned int DecodeUTF8(const std::string& s, size_t& i) {
+		unsigned char c = (unsigned char)s.at(i++);
+		if (c < 0x80) {
+			return c;
+		}
+		unsigned int cp = 0;
+		unsigned int extra = 0;
+		if ((c & 0xE0) == 0xC0) {
+			cp = c & 0x1F;
+			extra = 1;
+		}
+		else if ((c & 0xF0) == 0xE0) {
+			cp = c & 0x0F;
+			extra = 2;
+		}
+		else if ((c & 0xF8) == 0xF0) {
+			cp = c & 0x07;
+			extra = 3;
+		}
+		else {
+			return 0xFFFD;
+		}
+		for (unsigned int e = 0; e < extra; e++) {
+			if (i >= s.size() || ((unsigned char)s.at(i) & 0xC0) != 0x80) {
+				return 0xFFFD;
+			}
+			cp = (cp << 6) | ((unsigned char)s.at(i++) & 0x3F);
+		}
+		return cp;
+	}
+
+	void EncodeUTF8(unsigned int cp, std::string& s) {
+		if (cp < 0x80) {
+			s += (char)cp;
+		}
+		else if (cp < 0x800) {
+			s += (char)(0xC0 | (cp >> 6));
+			s += (char)(0x80 | (cp & 0x3F));
+		}
+		else if (cp < 0x10000) {
+			s += (char)(0xE0 | (cp >> 12));
+			s += (char)(0x80 | ((cp >> 6) & 0x3F));
+			s += (char)(0x80 | (cp & 0x3F));
+		}
+		else if (cp < 0x110000) {
+			s += (char)(0xF0 | (cp >> 18));
+			s += (char)(0x80 | ((cp >> 12) & 0x3F));
+			s += (char)(0x80 | ((cp >> 6) & 0x3F));
+			s += (char)(0x80 | (cp & 0x3F));
+		}
+	}
+
+	unsigned int LengthUTF8(const std::string& s) {
+		unsigned int count = 0;
+		size_t i = 0;
+		while (i < s.size()) {
+			DecodeUTF8(s, i);
+			count++;
+		}
+		return count;
+	}
+
+	size_t OffsetUTF8(const std::string& s, unsigned int cp) {
+		size_t i = 0;
+		for (unsigned int c = 0; c < cp && i < s.size(); c++) {
+			DecodeUTF8(s, i);
+		}
+		return i;
+	}
+
+	// Define Font functions.
+
+	void Font::init(FT_Library freeType, const std::string& fileName, unsigned int pixelSize,
+		size_t maxBytes) {
+		freeType_ = freeType;
+		fileName_ = fileName;
+		pixelSize_ = pixelSize;
+		maxPages_ = (unsigned int)(maxBytes / (PAGE_SIZE * PAGE_SIZE));
+		if (maxPages_ < 1) {
+			maxPages_ = 1;
+		}
+		frame_ = 1;
+	}
+
+	bool Font::open(FT_Face face) {
+		if (face != 0) {
+			if (face_ != 0) {
+				FT_Done_Face(face_);
+			}
+			face_ = face;
+		}
+		if (!openFace()) {
+			return false;
+		}
+		maxBearing = (float)(face_->size->metrics.ascender >> 6);
+		minBearing = (float)(-face_->size->metrics.descender >> 6);
+		loaded_ = true;
+		modified_ = true;
+		return true;
+	}
+
+	bool Font::openFace() const {
+		if (face_ != 0) {
+			return true;
+		}
+		FT_Face face;
+		if (FT_New_Face(freeType_, fileName_.c_str(), 0, &face) != FT_Err_Ok) {
+			ASCLOG(Font, Warning, "Failed to load font file ", fileName_, ".");
+			return false;
+		}
+		if (FT_Set_Pixel_Sizes(face, 0, pixelSize_) != FT_Err_Ok) {
+			ASCLOG(Font, Warning, "Failed to set size of font ", fileName_, ".");
+			FT_Done_Face(face);
+			return false;
+		}
+		face_ = face;
+		ASCLOG(Font, Info, "Opened font file ", fileName_, ".");
+		return true;
+	}
+
+	bool Font::load(const std::string& cacheFile, unsigned long long hash) {
+		cacheFile_ = cacheFile;
+		hash_ = hash;
+		std::ifstream file(cacheFile, std::ios::in | std::ios::binary);
+		if (!file.is_open()) {
+			return false;
+		}
+		char magic[4] = {};
+		unsigned int version = 0, pixelSize = 0, pageSize = 0, pageCount = 0, glyphCount = 0;
+		unsigned long long fileHash = 0;
+		float minB = 0.0f, maxB = 0.0f;
+		file.read(magic, sizeof(magic));
+		file.read((char*)&version, sizeof(version));
+		file.read((char*)&fileHash, sizeof(fileHash));
+		file.read((char*)&pixelSize, sizeof(pixelSize));
+		file.read((char*)&pageSize, sizeof(pageSize));
+		file.read((char*)&minB, sizeof(minB));
+		file.read((char*)&maxB, sizeof(maxB));
+		file.read((char*)&pageCount, sizeof(pageCount));
+		if (!file.good() || std::string(magic, sizeof(magic)) != "ASCF" || version != CACHE_VERSION
+			|| fileHash != hash || pixelSize != pixelSize_ || pageSize != PAGE_SIZE
+			|| pageCount > maxPages_) {
+			ASCLOG(Font, Info, "Font cache ", cacheFile, " does not match ", fileName_, ".");
+			return false;
+		}
+		std::vector<Page> pages(pageCount);
+		std::vector<unsigned char> bitmap(PAGE_SIZE * PAGE_SIZE);
+		for (Page& p : pages) {
+			file.read((char*)&p.shelfX, sizeof(p.shelfX));
+			file.read((char*)&p.shelfY, sizeof(p.shelfY));
+			file.read((char*)&p.shelfH, sizeof(p.shelfH));
+			file.read((char*)&bitmap[0], bitmap.size());
+			if (!file.good()) {
+				break;
+			}
+			glGenTextures(1, &p.texture);
+			glBindTexture(GL_TEXTURE_2D, p.texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, PAGE_SIZE, PAGE_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE,
+				&bitmap[0]);
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		file.read((char*)&glyphCount, sizeof(glyphCount));
+		std::unordered_map<unsigned int, Glyph> glyphs;
+		for (unsigned int i = 0; i < glyphCount && file.good(); i++) {
+			unsigned int cp = 0;
+			file.read((char*)&cp, sizeof(cp));
+			Glyph& g = glyphs[cp];
+			file.read((char*)&g.page, sizeof(g.page));
+			file.read((char*)&g.dims, sizeof(g.dims));
+			file.read((char*)&g.bearing, sizeof(g.bearing));
+			file.read((char*)&g.offset, sizeof(g.offset));
+			file.read((char*)&g.textureRect, sizeof(g.textureRect));
+			if (g.page != Glyph::NO_PAGE) {
+				if (g.page >= pages.size()) {
+					file.setstate(std::ios::failbit);
+					break;
+				}
+				g.texture = pages[g.page].texture;
+			}
+		}
+		if (!file.good()) {
+			ASCLOG(Font, Warning, "Font cache ", cacheFile, " is truncated.");
+			for (Page& p : pages) {
+				glDeleteTextures(1, &p.texture);
+			}
+			return false;
+		}
+		pages_ = pages;
+		glyphs_ = glyphs;
+		minBearing = minB;
+		maxBearing = maxB;
+		loaded_ = true;
+		modified_ = false;
+		ASCLOG(Font, Info, "Loaded ", glyphs_.size(), " glyphs of ", fileName_, " from cache ",
+			cacheFile, ".");
+		return true;
+	}
+
+	bool Font::save() const {
+		if (cacheFile_.empty() || !loaded_) {
+			return false;
+		}
+		if (!modified_) {
+			return true;
+		}
+		std::ofstream file(cacheFile_, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			ASCLOG(Font, Warning, "Failed to open font cache ", cacheFile_, ".");
+			return false;
+		}
+		unsigned int version = CACHE_VERSION;
+		unsigned int pageSize = PAGE_SIZE;
+		unsigned int pageCount = (unsigned int)pages_.size();
+		unsigned int glyphCount = (unsigned int)glyphs_.size();
+		file.write("ASCF", 4);
+		file.write((const char*)&version, sizeof(version));
+		file.write((const char*)&hash_, sizeof(hash_));
+		file.write((const char*)&pixelSize_, sizeof(pixelSize_));
+		file.write((const char*)&pageSize, sizeof(pageSize));
+		file.write((const char*)&minBearing, sizeof(minBearing));
+		file.write((const char*)&maxBearing, sizeof(maxBearing));
+		file.write((const char*)&pageCount, sizeof(pageCount));
+		std::vector<unsigned char> bitmap(PAGE_SIZE * PAGE_SIZE);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		for (const Page& p : pages_) {
+			file.write((const char*)&p.shelfX, sizeof(p.shelfX));
+			file.write((const char*)&p.shelfY, sizeof(p.shelfY));
+			file.write((const char*)&p.shelfH, sizeof(p.shelfH));
+			glBindTexture(GL_TEXTURE_2D, p.texture);
+			glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_UNSIGNED_BYTE, &bitmap[0]);
+			file.write((const char*)&bitmap[0], bitmap.size());
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		file.write((const char*)&glyphCount, sizeof(glyphCount));
+		for (const std::pair<const unsigned int, Glyph>& g : glyphs_) {
+			file.write((const char*)&g.first, sizeof(g.first));
+			file.write((const char*)&g.second.page, sizeof(g.second.page));
+			file.write((const char*)&g.second.dims, sizeof(g.second.dims));
+			file.write((const char*)&g.second.bearing, sizeof(g.second.bearing));
+			file.write((const char*)&g.second.offset, sizeof(g.second.offset));
+			file.write((const char*)&g.second.textureRect, sizeof(g.second.textureRect));
+		}
+		if (!file.good()) {
+			ASCLOG(Font, Warning, "Failed to write font cache ", cacheFile_, ".");
+			return false;
+		}
+		modified_ = false;
+		ASCLOG(Font, Info, "Saved ", glyphCount, " glyphs of ", fileName_, " to cache ", cacheFile_, ".");
+		return true;
+	}
+
+	bool Font::Render(FT_Face face, unsigned int cp, Bitmap& bmp) {
+		if (FT_Load_Char(face, cp, FT_LOAD_RENDER) != FT_Err_Ok) {
+			return false;
+		}
+		FT_GlyphSlot slot = face->glyph;
+		bmp.cp = cp;
+		bmp.dims = glm::ivec2(slot->bitmap.width, slot->bitmap.rows);
+		bmp.bearing = glm::ivec2(slot->bitmap_left, slot->bitmap_top);
+		bmp.offset = slot->advance.x >> 6;
+		bmp.pixels.assign(slot->bitmap.buffer,
+			slot->bitmap.buffer + (size_t)slot->bitmap.width * slot->bitmap.rows);
+		return true;
+	}
+
+	void Font::add(const std::vector<Bitmap>& bitmaps) {
+		if (!loaded_) {
+			return;
+		}
+		for (const Bitmap& b : bitmaps) {
+			if (glyphs_.find(b.cp) == glyphs_.end()) {
+				place(b);
+			}
+		}
+	}
+
+	const Glyph* Font::getGlyph(unsigned int cp) const {
+		if (!loaded_) {
+			return 0;
+		}
+		const Glyph* g = 0;
+		if (cp < HOT_GLYPHS && hot_[cp] != 0) {
+			g = hot_[cp];
+		}
+		else {
+			std::unordered_map<unsigned int, Glyph>::const_iterator it = glyphs_.find(cp);
+			if (it != glyphs_.end()) {
+				g = &it->second;
+			}
+			else {
+				g = &rasterize(cp);
+			}
+			if (cp < HOT_GLYPHS) {
+				hot_[cp] = g;
+			}
+		}
+		if (g->page != Glyph::NO_PAGE) {
+			pages_[g->page].lastUse = frame_;
+		}
+		return g;
+	}
+
+	void Font::destroy() {
+		for (Page& p : pages_) {
+			glDeleteTextures(1, &p.texture);
+		}
+		pages_.clear();
+		glyphs_.clear();
+		for (unsigned int h = 0; h < HOT_GLYPHS; h++) {
+			hot_[h] = 0;
+		}
+		if (face_ != 0) {
+			FT_Done_Face(face_);
+		}
+		face_ = 0;
+		freeType_ = 0;
+		fileName_ = "";
+		cacheFile_ = "";
+		loaded_ = false;
+		modified_ = false;
+		minBearing = 0.0f;
+		maxBearing = 0.0f;
+	}
+
+	Glyph& Font::rasterize(unsigned int cp) const {
+		Bitmap bmp;
+		if (!openFace() || !Render(face_, cp, bmp)) {
+			ASCLOG(Font, Warning, "Failed to load character ", cp, ".");
+			modified_ = true;
+			return glyphs_[cp];
+		}
+		return place(bmp);
+	}
+
+	Glyph& Font::place(const Bitmap& bmp) const {
+		Glyph& g = glyphs_[bmp.cp];
+		modified_ = true;
+		g.dims = glm::vec2(bmp.dims);
+		g.bearing = bmp.bearing;
+		g.offset = bmp.offset;
+		if (bmp.dims.x == 0 || bmp.dims.y == 0) {
+			return g;
+		}
+		glm::ivec2 dims = bmp.dims;
+		if (dims.x > PAGE_SIZE || dims.y > PAGE_SIZE) {
+			ASCLOG(Font, Warning, "Character ", bmp.cp, " is too large for atlas pages.");
+			g.dims = glm::vec2();
+			return g;
+		}
+		glm::ivec2 pos;
+		g.page = reserve(dims, pos);
+		g.texture = pages_[g.page].texture;
+		g.textureRect = glm::vec4((float)pos.x / PAGE_SIZE, (float)pos.y / PAGE_SIZE,
+			(float)dims.x / PAGE_SIZE, (float)dims.y / PAGE_SIZE);
+		glBindTexture(GL_TEXTURE_2D, g.texture);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, dims.x, dims.y, GL_RED, GL_UNSIGNED_BYTE,
+			&bmp.pixels[0]);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return g;
+	}
+
+	unsigned int Font::reserve(const glm::ivec2& dims, glm::ivec2& pos) const {
+		// Pad bitmaps by a pixel so linear filtering does not bleed between glyphs.
+		glm::ivec2 padded = dims + glm::ivec2(1, 1);
+		if (!pages_.empty()) {
+			Page& p = pages_.back();
+			if (p.shelfX + padded.x > PAGE_SIZE) {
+				p.shelfX = 0;
+				p.shelfY += p.shelfH;
+				p.shelfH = 0;
+			}
+			if (p.shelfY + padded.y <= PAGE_SIZE) {
+				pos = glm::ivec2(p.shelfX, p.shelfY);
+				p.shelfX += padded.x;
+				if (padded.y > p.shelfH) {
+					p.shelfH = padded.y;
+				}
+				return (unsigned int)pages_.size() - 1;
+			}
+		}
+		std::vector<unsigned char> blank(PAGE_SIZE * PAGE_SIZE, 0);
+		unsigned int index = (unsigned int)pages_.size();
+		if (pages_.size() >= maxPages_) {
+			unsigned int lru = index;
+			for (unsigned int p = 0; p < pages_.size(); p++) {
+				if (pages_[p].lastUse < frame_
+					&& (lru == index || pages_[p].lastUse < pages_[lru].lastUse)) {
+					lru = p;
+				}
+			}
+			if (lru != index) {
+				evict(lru);
+				// Move the cleared page to the back so it becomes the page being filled.
+				std::swap(pages_[lru], pages_.back());
+				for (std::pair<const unsigned int, Glyph>& g : glyphs_) {
+					if (g.second.page == lru) {
+						g.second.page = (unsigned int)pages_.size() - 1;
+					}
+					else if (g.second.page == pages_.size() - 1) {
+						g.second.page = lru;
+					}
+				}
+				index = (unsigned int)pages_.size() - 1;
+				glBindTexture(GL_TEXTURE_2D, pages_[index].texture);
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, PAGE_SIZE, PAGE_SIZE, GL_RED, GL_UNSIGNED_BYTE,
+					&blank[0]);
+			}
+			else {
+				ASCLOG(Font, Warning, "All ", pages_.size(), " atlas pages in use this frame, exceeding memory cap.");
+			}
+		}
+		if (index == pages_.size()) {
+			pages_.push_back(Page());
+			glGenTextures(1, &pages_[index].texture);
+			glBindTexture(GL_TEXTURE_2D, pages_[index].texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, PAGE_SIZE, PAGE_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE,
+				&blank[0]);
+			ASCLOG(Font, Info, "Added atlas page ", index, ".");
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		Page& p = pages_[index];
+		pos = glm::ivec2(0, 0);
+		p.shelfX = padded.x;
+		p.shelfY = 0;
+		p.shelfH = padded.y;
+		p.lastUse = frame_;
+		return index;
+	}
+
+	void Font::evict(unsigned int page) const {
+		generation_++;
+		unsigned int count = 0;
+		std::unordered_map<unsigned int, Glyph>::iterator it = glyphs_.begin();
+		while (it != glyphs_.end()) {
+			if (it->second.page == page) {
+				if (it->first < HOT_GLYPHS) {
+					hot_[it->first] = 0;
+				}
+				it = glyphs_.erase(it);
+				count++;
+			}
+			else {
+				it++;
+			}
+		}
+		ASCLOG(Font, Info, "Evicted ", count, " glyphs from atlas page ", page, ".");
+	}
+
+	// Define TextRun functions.
+
+	void TextRun::set(const std::string& text, const glm::vec3& pos, const glm::vec4& bounds,
+		float scale, const glm::vec3& color, const Font& font, Alignment hAlign, Alignment vAlign) {
+		if (text == text_ && pos == pos_ && bounds == bounds_ && scale == scale_ && color == color_
+			&& &font == font_ && hAlign == hAlign_ && vAlign == vAlign_) {
+			return;
+		}
+		text_ = text;
+		pos_ = pos;
+		bounds_ = bounds;
+		scale_ = scale;
+		color_ = color;
+		font_ = &font;
+		hAlign_ = hAlign;
+		vAlign_ = vAlign;
+		dirty_ = true;
+	}
+
+	void TextRun::destroy() {
+		text_ = "";
+		font_ = 0;
+		dirty_ = true;
+		generation_ = 0;
+		width_ = 0.0f;
+		vertices_.clear();
+		segments_.clear();
+	}
+
+	void TextRun::layout() {
+		dirty_ = false;
+		vertices_.clear();
+		segments_.clear();
+		width_ = 0.0f;
+		if (font_ == 0 || !font_->isLoaded() || text_.empty()) {
+			return;
+		}
+		std::pmr::vector<const Glyph*> glyphs(&App::frameArena());
+		glyphs.reserve(text_.size());
+		size_t i = 0;
+		while (i < text_.size()) {
+			const Glyph* g = font_->getGlyph(DecodeUTF8(text_, i));
+			if (g != 0) {
+				glyphs.push_back(g);
+				width_ += g->offset * scale_;
+			}
+		}
+		generation_ = font_->getGeneration();
+		if (glyphs.empty()) {
+			return;
+		}
+		float minBearing = font_->minBearing * scale_;
+		float maxBearing = font_->maxBearing * scale_;
+		float height = minBearing + maxBearing;
+		float x = 0.0f;
+		float y = 0.0f;
+		if (hAlign_ == ASC_ALIGN_LEFT) {
+			x = bounds_.x;
+		}
+		else if (hAlign_ == ASC_ALIGN_RIGHT) {
+			x = (bounds_.x + bounds_.z) - width_;
+		}
+		else if (hAlign_ == ASC_ALIGN_CENTER) {
+			float m = bounds_.x + (bounds_.z / 2.0f);
+			x = m - (width_ / 2.0f);
+		}
+		else {
+			x = pos_.x;
+		}
+		if (vAlign_ == ASC_ALIGN_BOTTOM) {
+			y = bounds_.y + minBearing;
+		}
+		else if (vAlign_ == ASC_ALIGN_TOP) {
+			y = (bounds_.y + bounds_.w) - height;
+		}
+		else if (vAlign_ == ASC_ALIGN_CENTER) {
+			float m = bounds_.y + (bounds_.w / 2.0f);
+			y = m - (height / 2.0f);
+		}
+		else {
+			y = pos_.y;
+		}
+		x -= glyphs.front()->bearing.x * scale_;
+		// Place visible quads in text order, then group them by page to share draws.
+		std::pmr::vector<std::pair<unsigned int, glm::vec4>> quads(&App::frameArena());
+		quads.reserve(glyphs.size());
+		for (unsigned int q = 0; q < glyphs.size(); q++) {
+			const Glyph* g = glyphs[q];
+			glm::vec4 r(x + g->bearing.x * scale_, y - ((g->dims.y - g->bearing.y) * scale_),
+				g->dims.x * scale_, g->dims.y * scale_);
+			x += g->offset * scale_;
+			if (g->page == Glyph::NO_PAGE) {
+				continue;
+			}
+			if (r.x < bounds_.x || r.x + r.z > bounds_.x + bounds_.z
+				|| r.y < bounds_.y || r.y + r.w > bounds_.y + bounds_.w) {
+				continue;
+			}
+			quads.push_back(std::pair<unsigned int, glm::vec4>(q, r));
+		}
+		std::stable_sort(quads.begin(), quads.end(),
+			[&glyphs](const std::pair<unsigned int, glm::vec4>& a,
+				const std::pair<unsigned int, glm::vec4>& b) {
+				return glyphs[a.first]->page < glyphs[b.first]->page;
+			});
+		vertices_.reserve(quads.size() * 4 * Sprite::VERTEX_FLOATS);
+		for (const std::pair<unsigned int, glm::vec4>& q : quads) {
+			const Glyph* g = glyphs[q.first];
+			const glm::vec4& r = q.second;
+			const glm::vec4& t = g->textureRect;
+			if (segments_.empty() || segments_.back().page != g->page) {
+				Segment seg;
+				seg.texture = g->texture;
+				seg.page = g->page;
+				seg.first = (unsigned int)(vertices_.size() / (4 * Sprite::VERTEX_FLOATS));
+				segments_.push_back(seg);
+			}
+			segments_.back().quads++;
+			vertices_.insert(vertices_.end(), {
+				r.x, r.y, pos_.z,
+				t.x, t.y + t.w,
+				color_.x, color_.y, color_.z,
+				r.x + r.z, r.y, pos_.z,
+				t.x + t.z, t.y + t.w,
+				color_.x, color_.y, color_.z,
+				r.x + r.z, r.y + r.w, pos_.z,
+				t.x + t.z, t.y,
+				color_.x, color_.y, color_.z,
+				r.x, r.y + r.w, pos_.z,
+				t.x, t.y,
+				color_.x, color_.y, color_.z,
+			});
+		}
+	}
 }
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include <glm/glm.hpp>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <ft2build.h>
 #include <freetype/freetype.h>
 
@@ -23,6 +24,23 @@ namespace ASC {
 		glm::vec3 pos = glm::vec3();
 		// The velocity of this entity.
 		glm::vec2 vel = glm::vec2();
+
+		/*
+		* Get this entity's position between the start and end of its last fixed update.
+		* @param float alpha: The fraction of a fixed update elapsed since the last one (0 to 1).
+		* @return The interpolated position and depth, or the current one if this entity was moved
+		* outside of an update since or was not updated in the latest one.
+		*/
+		glm::vec3 getLerpPos(float) const;
+
+	protected:
+		// The renderer's fixed update count when this entity was last updated.
+		unsigned long long tick_ = 0;
+
+		// The position of this entity at the start of its last fixed update.
+		glm::vec3 tickStartPos_ = glm::vec3();
+		// The position of this entity at the end of its last fixed update.
+		glm::vec3 tickEndPos_ = glm::vec3();
 	};
 
 	// Class for generating 2D projection matrix with camera position and scale.
@@ -32,6 +50,8 @@ namespace ASC {
 		float scale = 1.0f;
 		// The velocity of this camera's scale.
 		float scaleVel = 0.0f;
+		// The dimensions in pixels of the view this camera projects to, 0 to use the window's.
+		glm::ivec2 viewDims = glm::ivec2();
 
 		/*
 		* Assignment operator for cameras.
@@ -48,11 +68,25 @@ namespace ASC {
 		*/
 		void update(float);
 		/*
+		* Set this camera's matrix to its position and scale interpolated between the start and end
+		* of its last update, without moving the camera.
+		* @param float alpha: The fraction of a fixed update elapsed since the last one (0 to 1).
+		*/
+		void interpolate(float);
+		/*
 		* @return The projection matrix for this camera's position and scale.
 		*/
 		const glm::mat4& getMatrix() const {
 			return matrix_;
 		}
+		/*
+		* @return The dimensions in pixels this camera projects to.
+		*/
+		glm::ivec2 getViewDims() const;
+		/*
+		* @return The rectangle of the world visible to this camera (x, y, w, h).
+		*/
+		glm::vec4 getBounds() const;
 
 	private:
 		// Basic orthographic projection matrix.
@@ -65,16 +99,25 @@ namespace ASC {
 		float prevScale_ = 1.0f;
 		// The dimensions of the window in the previous update.
 		glm::ivec2 prevWindowDims_ = glm::ivec2();
+		// The scale of this camera at the start of its last fixed update.
+		float tickStartScale_ = 1.0f;
+		// The scale of this camera at the end of its last fixed update.
+		float tickEndScale_ = 1.0f;
 
 		/*
-		* Update this camera's projection matrix based on position and scale.
+		* Update this camera's projection matrix based on a position and scale.
+		* @param const glm::vec3& pos: The position to center the projection on.
+		* @param float scale: The scale of the projection.
 		*/
-		void updateMatrix();
+		void updateMatrix(const glm::vec3&, float);
 	};
 
 	// Abstract 2D sprite, textured quad.
 	class Sprite : public Entity {
 	public:
+		// The number of floats in each vertex of a sprite.
+		static const unsigned int VERTEX_FLOATS = 8;
+
 		// The dimensions in pixels of this sprite.
 		glm::vec2 dims = glm::vec2();
 		// Rotation in degrees of this sprite.
@@ -85,8 +128,11 @@ namespace ASC {
 		GLuint texture = 0;
 		// The texture coordinates to use for this sprite (x, y, w, h).
 		glm::vec4 textureRect = glm::vec4();
-		// The background color of this sprite, must be 0 to display texture.
+		// The color of this sprite, filling it if it has no texture and otherwise masking the
+		// texture's red channel as alpha unless tint is set, must be 0 to display texture as is.
 		glm::vec3 color = glm::vec3();
+		// Whether to multiply this sprite's texture by its color instead of masking it.
+		bool tint = false;
 		// Whether to reflect this sprite's texture horizontally.
 		bool reflectH = false;
 		// Whether to reflect this sprite's texture vertically.
@@ -114,6 +160,13 @@ namespace ASC {
 		* @return Whether this sprite intersects the sprite s's rectangle.
 		*/
 		virtual bool intersects(const Sprite&);
+		/*
+		* Get this sprite's rotation between the start and end of its last fixed update.
+		* @param float alpha: The fraction of a fixed update elapsed since the last one (0 to 1).
+		* @return The interpolated rotation in degrees, or the current one if this sprite was moved
+		* or rotated outside of an update since or was not updated in the latest one.
+		*/
+		float getLerpRot(float) const;
 
 	protected:
 		friend class Renderer;
@@ -122,17 +175,25 @@ namespace ASC {
 		static std::vector<unsigned int> Indices;
 		// The vertex data for this sprite.
 		std::vector<float> vertices_;
+		// The rotation of this sprite at the start of its last fixed update.
+		float tickStartRot_ = 0.0f;
+		// The rotation of this sprite at the end of its last fixed update.
+		float tickEndRot_ = 0.0f;
 
 		/*
 		* Populate this sprite's vertex data based on position, rotation, color, etc.
+		* @param float alpha: The fraction of a fixed update elapsed since the last one to
+		* interpolate position and rotation by.
 		*/
-		virtual void draw();
+		virtual void draw(float = 1.0f);
 		/*
 		* Rotate a 2D point about this sprite's center while preserving depth.
 		* @param const glm::vec3& p: The point to rotate with depth.
-		* @return The point p rotated by rot about this sprite's center.
+		* @param const glm::vec3& at: The position of this sprite to rotate about the center of.
+		* @param float deg: The rotation in degrees.
+		* @return The point p rotated by deg about this sprite's center.
 		*/
-		glm::vec3 rotate(const glm::vec3&);
+		glm::vec3 rotate(const glm::vec3&, const glm::vec3&, float);
 	};
 
 	// Looping animation class based on 2D sprite.
@@ -201,21 +262,330 @@ namespace ASC {
 	// A single character in a font.
 	class Glyph : public Sprite {
 	public:
+		// Page index for glyphs with no bitmap in their font's atlas.
+		static const unsigned int NO_PAGE = 0xFFFFFFFF;
+
 		// Bearing for this character's texture.
 		glm::ivec2 bearing = glm::ivec2();
 		// Width of this character.
 		unsigned int offset = 0;
+		// The index of the font atlas page holding this character's bitmap.
+		unsigned int page = NO_PAGE;
 	};
 
-	// Set of glyphs loaded from TTF file via FreeType.
+	/*
+	* Decode the next codepoint of a UTF-8 string.
+	* @param const std::string& s: The UTF-8 string to decode.
+	* @param size_t& i: The byte index to decode at, advanced past the codepoint.
+	* @return The decoded codepoint or U+FFFD if the sequence is malformed.
+	*/
+	unsigned int DecodeUTF8(const std::string&, size_t&);
+	/*
+	* Append a codepoint to a string in UTF-8 encoding.
+	* @param unsigned int cp: The codepoint to encode.
+	* @param std::string& s: The string to append to.
+	*/
+	void EncodeUTF8(unsigned int, std::string&);
+	/*
+	* @param const std::string& s: A UTF-8 string.
+	* @return The number of codepoints in the string s.
+	*/
+	unsigned int LengthUTF8(const std::string&);
+	/*
+	* Find the byte index of a codepoint in a UTF-8 string.
+	* @param const std::string& s: The UTF-8 string to search.
+	* @param unsigned int cp: The index of the codepoint to find.
+	* @return The byte index of codepoint cp or the length of s if out of range.
+	*/
+	size_t OffsetUTF8(const std::string&, unsigned int);
+
+	// Set of glyphs rasterized on first use from a TTF file via FreeType into atlas pages.
 	class Font {
 	public:
+		// Number of leading codepoints kept in this font's flat lookup table.
+		static const unsigned int HOT_GLYPHS = 128;
+		// Width and height in pixels of each of this font's atlas pages.
+		static const int PAGE_SIZE = 512;
+		// Version of the font cache file format, cache files of other versions are ignored.
+		static const unsigned int CACHE_VERSION = 1;
+
+		// Character rendered by FreeType but not yet packed into an atlas page.
+		struct Bitmap {
+			// The codepoint of the character.
+			unsigned int cp = 0;
+			// The dimensions of the bitmap.
+			glm::ivec2 dims = glm::ivec2();
+			// Bearing for the character's texture.
+			glm::ivec2 bearing = glm::ivec2();
+			// Width of the character.
+			unsigned int offset = 0;
+			// The coverage of each pixel, rows packed without padding.
+			std::vector<unsigned char> pixels;
+		};
+
 		// The minimum vertical character bearing of this font.
 		float minBearing = 0.0f;
 		// The maximum vertical character bearing of this font.
 		float maxBearing = 0.0f;
-		// Set of characters in this font.
-		std::map<char, Glyph> glyphs;
+
+		/*
+		* Construct an empty font.
+		*/
+		Font() = default;
+		/*
+		* Do not copy fonts, they own their FreeType face and atlas textures.
+		*/
+		Font(const Font&) = delete;
+		/*
+		* Do not assign fonts, they own their FreeType face and atlas textures.
+		*/
+		Font& operator = (const Font&) = delete;
+		/*
+		* Initialize this font's memory, the font file is not opened until required.
+		* @param FT_Library freeType: The FreeType library to open the font file with.
+		* @param const std::string& fileName: The path to the TTF font file.
+		* @param unsigned int pixelSize: The height in pixels to rasterize glyphs at.
+		* @param size_t maxBytes: The atlas memory to keep before evicting unused pages.
+		*/
+		void init(FT_Library, const std::string&, unsigned int, size_t);
+		/*
+		* Open this font's file with FreeType and read its metrics, used when there is no cache.
+		* @param FT_Face face: A face already opened and sized on this font's file to take
+		* ownership of, 0 to open one.
+		* @return Whether the font file could be opened and sized.
+		*/
+		bool open(FT_Face = 0);
+		/*
+		* Load this font's metrics and atlas pages from a cache file written by save().
+		* @param const std::string& cacheFile: The path to the cache file.
+		* @param unsigned long long hash: The hash of the font file's contents.
+		* @return Whether the cache file exists and matches this font.
+		*/
+		bool load(const std::string&, unsigned long long);
+		/*
+		* Write this font's metrics and atlas pages to its cache file if glyphs were added
+		* since it was loaded.
+		* @return Whether the cache file is up to date.
+		*/
+		bool save() const;
+		/*
+		* Render a character with FreeType, does not need the OpenGL context.
+		* @param FT_Face face: The sized face to render with, used by one thread at a time.
+		* @param unsigned int cp: The codepoint of the character.
+		* @param Bitmap& bmp: Set to the rendered character.
+		* @return Whether the character could be rendered.
+		*/
+		static bool Render(FT_Face, unsigned int, Bitmap&);
+		/*
+		* Pack characters rendered ahead of time into atlas pages, skipping ones already loaded.
+		* @param const std::vector<Bitmap>& bitmaps: The rendered characters.
+		*/
+		void add(const std::vector<Bitmap>&);
+		/*
+		* Get a character of this font, rasterizing it on first use.
+		* @param unsigned int cp: The codepoint of the character.
+		* @return The glyph for the codepoint or 0 if it could not be loaded.
+		*/
+		const Glyph* getGlyph(unsigned int) const;
+		/*
+		* Start a new frame, pages used from now on will not be evicted until the next tick.
+		*/
+		inline void tick() {
+			frame_++;
+		}
+		/*
+		* Mark an atlas page as used this frame so it will not be evicted.
+		* @param unsigned int page: The index of the page.
+		*/
+		inline void touch(unsigned int page) const {
+			if (page < pages_.size()) {
+				pages_[page].lastUse = frame_;
+			}
+		}
+		/*
+		* @return The number of pages evicted by this font, layouts of its glyphs are stale
+		* when this changes.
+		*/
+		inline unsigned int getGeneration() const {
+			return generation_;
+		}
+		/*
+		* Free this font's atlas pages and FreeType face.
+		*/
+		void destroy();
+		/*
+		* @return Whether this font has been loaded from a file.
+		*/
+		inline bool isLoaded() const {
+			return loaded_;
+		}
+		/*
+		* @return The number of glyphs currently rasterized in this font.
+		*/
+		inline unsigned int getGlyphCount() const {
+			return (unsigned int)glyphs_.size();
+		}
+		/*
+		* @return The memory in bytes of this font's atlas pages.
+		*/
+		inline size_t getMemory() const {
+			return pages_.size() * PAGE_SIZE * PAGE_SIZE;
+		}
+
+	private:
+		// Atlas texture with glyph bitmaps packed in shelves.
+		struct Page {
+			// The OpenGL texture ID of this page.
+			GLuint texture = 0;
+			// The x position of the next glyph on the current shelf.
+			int shelfX = 0;
+			// The y position of the current shelf.
+			int shelfY = 0;
+			// The height of the tallest glyph on the current shelf.
+			int shelfH = 0;
+			// The last frame a glyph on this page was used.
+			unsigned long long lastUse = 0;
+		};
+
+		// The FreeType library used to open this font's file.
+		FT_Library freeType_ = 0;
+		// The path to this font's TTF file.
+		std::string fileName_ = "";
+		// The height in pixels glyphs are rasterized at.
+		unsigned int pixelSize_ = 0;
+		// Whether this font's metrics have been loaded from its file or cache.
+		bool loaded_ = false;
+		// The FreeType face glyphs are rasterized from, opened on the first cache miss.
+		mutable FT_Face face_ = 0;
+		// The path to this font's cache file, empty if not cached.
+		std::string cacheFile_ = "";
+		// The hash of this font file's contents.
+		unsigned long long hash_ = 0;
+		// Whether glyphs have changed since this font was loaded from its cache.
+		mutable bool modified_ = false;
+		// The maximum number of atlas pages before unused pages are evicted.
+		unsigned int maxPages_ = 1;
+		// The current frame of this font for page eviction.
+		unsigned long long frame_ = 1;
+		// The number of pages evicted by this font.
+		mutable unsigned int generation_ = 0;
+		// The atlas pages of this font.
+		mutable std::vector<Page> pages_;
+		// Set of rasterized glyphs mapped by codepoint.
+		mutable std::unordered_map<unsigned int, Glyph> glyphs_;
+		// Flat lookup table for rasterized glyphs of the leading codepoints.
+		mutable const Glyph* hot_[HOT_GLYPHS] = {};
+
+		/*
+		* Rasterize a character with FreeType and pack it in an atlas page.
+		* @param unsigned int cp: The codepoint of the character.
+		* @return The new glyph.
+		*/
+		Glyph& rasterize(unsigned int) const;
+		/*
+		* Pack a rendered character in an atlas page.
+		* @param const Bitmap& bmp: The rendered character.
+		* @return The new glyph.
+		*/
+		Glyph& place(const Bitmap&) const;
+		/*
+		* Reserve space for a bitmap in an atlas page, evicting or adding pages as required.
+		* @param const glm::ivec2& dims: The dimensions of the bitmap.
+		* @param glm::ivec2& pos: Set to the position of the reserved space.
+		* @return The index of the page with the reserved space.
+		*/
+		unsigned int reserve(const glm::ivec2&, glm::ivec2&) const;
+		/*
+		* Remove all glyphs on an atlas page and clear it for reuse.
+		* @param unsigned int page: The index of the page to evict.
+		*/
+		void evict(unsigned int) const;
+		/*
+		* Open this font's FreeType face if it is not open already.
+		* @return Whether the face is open.
+		*/
+		bool openFace() const;
+	};
+
+	// String of text laid out in a font as precomputed quads, only laid out again when changed.
+	class TextRun {
+	public:
+		/*
+		* Set the text and layout parameters of this run, marking it for layout if any changed.
+		* @param const std::string& text: The UTF-8 text to draw.
+		* @param const glm::vec3& pos: The position to start drawing this text at.
+		* @param const glm::vec4& bounds: Rectangle to draw the text inside of (x, y, w, h).
+		* @param float scale: The scale to draw this text at.
+		* @param const glm::vec3& color: The color to draw this text in.
+		* @param const Font& font: The font to draw this text in.
+		* @param Alignment hAlign: The horizontal alignment of the text in its bounds.
+		* @param Alignment vAlign: The vertical alignment of the text in its bounds.
+		*/
+		void set(const std::string&, const glm::vec3&, const glm::vec4&, float, const glm::vec3&,
+			const Font&, Alignment, Alignment);
+		/*
+		* Free this run's memory.
+		*/
+		void destroy();
+		/*
+		* @return The text of this run.
+		*/
+		inline const std::string& getText() const {
+			return text_;
+		}
+		/*
+		* @return The width of this run's text as of its last layout.
+		*/
+		inline float getWidth() const {
+			return width_;
+		}
+
+	private:
+		friend class Renderer;
+
+		// Range of this run's quads sharing an atlas page.
+		struct Segment {
+			// The texture ID of the atlas page.
+			GLuint texture = 0;
+			// The index of the atlas page in the font.
+			unsigned int page = 0;
+			// The index of the first quad in this segment.
+			unsigned int first = 0;
+			// The number of quads in this segment.
+			unsigned int quads = 0;
+		};
+
+		// The text of this run.
+		std::string text_ = "";
+		// The position to start drawing this run at.
+		glm::vec3 pos_ = glm::vec3();
+		// The rectangle to draw this run inside of (x, y, w, h).
+		glm::vec4 bounds_ = glm::vec4();
+		// The scale to draw this run at.
+		float scale_ = 1.0f;
+		// The color to draw this run in.
+		glm::vec3 color_ = glm::vec3();
+		// The font to draw this run in.
+		const Font* font_ = 0;
+		// The horizontal alignment of this run in its bounds.
+		Alignment hAlign_ = ASC_ALIGN_NONE;
+		// The vertical alignment of this run in its bounds.
+		Alignment vAlign_ = ASC_ALIGN_NONE;
+		// Whether this run must be laid out before it is drawn.
+		bool dirty_ = true;
+		// The font generation at this run's last layout.
+		unsigned int generation_ = 0;
+		// The width of this run's text at its last layout.
+		float width_ = 0.0f;
+		// The vertex data of this run's quads grouped by atlas page.
+		std::vector<float> vertices_;
+		// The ranges of this run's quads sharing an atlas page.
+		std::vector<Segment> segments_;
+
+		/*
+		* Measure this run's text and build its quads.
+		*/
+		void layout();
 	};
 }
 
@@ -5,6 +5,11 @@
 */
 
 #include <fstream>
+#include <tuple>
+#include <filesystem>
+#include <sstream>
+#include <iomanip>
+#include <atomic>
 
 #include "Asclepias.h"
 
@@ -15,10 +20,21 @@ extern int decodePNG(std::vector<unsigned char>& out_image, unsigned long& image
 	bool convert_to_rgba32 = true);
 
 namespace ASC {
+	unsigned long long HashBytes(const void* data, size_t size, unsigned long long hash) {
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
 	// Define Shader functions.
 
+	std::string Shader::CACHE_DIR = "";
+
 	void Shader::operator = (const Shader& s) {
-		ID_ = s.ID_;
+		programs_ = s.programs_;
 		attributes_.clear();
 		for (const VAttrib& v : s.attributes_) {
 			attributes_.push_back(v);
@@ -29,9 +45,66 @@ namespace ASC {
 	}
 
 	bool Shader::init(const std::string& vSource, const std::string& fSource,
-		const std::string& cameraUniform, const std::vector<unsigned int>& attribSizes) {
+		const std::string& cameraUniform, const std::vector<unsigned int>& attribSizes,
+		const std::vector<std::string>& variants) {
 		camera_.init();
 		cameraUniform_ = cameraUniform;
+		attributes_.resize(attribSizes.size());
+		stride_ = 0;
+		for (unsigned int a = 0; a < attribSizes.size(); a++) {
+			attributes_[a].size = attribSizes.at(a);
+			attributes_[a].offset = stride_ * sizeof(float);
+			stride_ += attribSizes.at(a);
+		}
+		stride_ *= sizeof(float);
+		if (variants.empty()) {
+			GLuint program = link(vSource, fSource);
+			if (program == 0) {
+				return false;
+			}
+			programs_.push_back(program);
+			return true;
+		}
+		for (const std::string& v : variants) {
+			std::string define = "#define " + v + "\n";
+			std::string vs = vSource, fs = fSource;
+			vs.insert(vs.find('\n') == std::string::npos ? 0 : vs.find('\n') + 1, define);
+			fs.insert(fs.find('\n') == std::string::npos ? 0 : fs.find('\n') + 1, define);
+			GLuint program = link(vs, fs);
+			if (program == 0) {
+				ASCLOG(Shader, Warning, "Failed to build shader variant ", v, ".");
+				destroy();
+				return false;
+			}
+			programs_.push_back(program);
+			ASCLOG(Shader, Info, "Built shader variant ", v, " as program ", program, ".");
+		}
+		return true;
+	}
+
+	GLuint Shader::link(const std::string& vSource, const std::string& fSource) const {
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		std::string cacheFile = "";
+		unsigned long long hash = 0;
+		if (!CACHE_DIR.empty() && formats > 0) {
+			std::string driver = std::string((const char*)glGetString(GL_VENDOR)) + "|"
+				+ (const char*)glGetString(GL_RENDERER) + "|" + (const char*)glGetString(GL_VERSION);
+			hash = HashBytes(driver.data(), driver.size());
+			hash = HashBytes(vSource.data(), vSource.size(), hash);
+			hash = HashBytes(fSource.data(), fSource.size(), hash);
+			std::stringstream ss;
+			ss << CACHE_DIR << "/" << std::hex << std::setw(16) << std::setfill('0') << hash
+				<< ".shader";
+			cacheFile = ss.str();
+			GLuint program = loadBinary(cacheFile, hash);
+			if (program != 0) {
+				ASCLOG(Shader, Info, "Shader cache hit, loaded program ", program, " from ",
+					cacheFile, ".");
+				return program;
+			}
+			ASCLOG(Shader, Info, "Shader cache miss for ", cacheFile, ", compiling from source.");
+		}
 		const char* vSourceC = vSource.c_str();
 		GLuint vShader = glCreateShader(GL_VERTEX_SHADER);
 		glShaderSource(vShader, 1, &vSourceC, 0);
@@ -42,7 +115,8 @@ namespace ASC {
 			char vbuf[512];
 			glGetShaderInfoLog(vShader, 512, 0, vbuf);
 			ASCLOG(Shader, Warning, "Failed to compile vertex shader source.\n", vbuf);
-			return false;
+			glDeleteShader(vShader);
+			return 0;
 		}
 		ASCLOG(Shader, Info, "Compiled vertex shader ", vShader, ".");
 		const char* fSourceC = fSource.c_str();
@@ -55,48 +129,120 @@ namespace ASC {
 			char fbuf[512];
 			glGetShaderInfoLog(fShader, 512, 0, fbuf);
 			ASCLOG(Shader, Warning, "Failed to compile fragment shader source.\n", fbuf);
-			return false;
+			glDeleteShader(vShader);
+			glDeleteShader(fShader);
+			return 0;
 		}
 		ASCLOG(Shader, Info, "Compiled fragment shader ", fShader, ".");
-		ID_ = glCreateProgram();
-		glAttachShader(ID_, vShader);
-		glAttachShader(ID_, fShader);
-		glLinkProgram(ID_);
+		GLuint program = glCreateProgram();
+		glAttachShader(program, vShader);
+		glAttachShader(program, fShader);
+		if (!cacheFile.empty()) {
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+		glLinkProgram(program);
+		glDeleteShader(vShader);
+		glDeleteShader(fShader);
 		int ps;
-		glGetProgramiv(ID_, GL_LINK_STATUS, &ps);
+		glGetProgramiv(program, GL_LINK_STATUS, &ps);
 		if (!ps) {
 			char pbuf[512];
-			glGetProgramInfoLog(ID_, 512, 0, pbuf);
+			glGetProgramInfoLog(program, 512, 0, pbuf);
 			ASCLOG(Shader, Warning, "Failed to link shader program.\n", pbuf);
+			glDeleteProgram(program);
+			return 0;
+		}
+		ASCLOG(Shader, Info, "Linked shader program ", program, ".");
+		if (!cacheFile.empty()) {
+			saveBinary(program, cacheFile, hash);
+		}
+		return program;
+	}
+
+	GLuint Shader::loadBinary(const std::string& cacheFile, unsigned long long hash) const {
+		std::ifstream file(cacheFile, std::ios::in | std::ios::binary);
+		if (!file.is_open()) {
+			return 0;
+		}
+		char magic[4] = {};
+		unsigned int version = 0, length = 0;
+		unsigned long long fileHash = 0;
+		GLenum format = 0;
+		file.read(magic, sizeof(magic));
+		file.read((char*)&version, sizeof(version));
+		file.read((char*)&fileHash, sizeof(fileHash));
+		file.read((char*)&format, sizeof(format));
+		file.read((char*)&length, sizeof(length));
+		if (!file.good() || std::string(magic, sizeof(magic)) != "ASCS" || version != CACHE_VERSION
+			|| fileHash != hash || length == 0) {
+			return 0;
+		}
+		std::vector<char> binary(length);
+		file.read(&binary[0], length);
+		if (!file.good()) {
+			return 0;
+		}
+		GLuint program = glCreateProgram();
+		glProgramBinary(program, format, &binary[0], length);
+		int ps;
+		glGetProgramiv(program, GL_LINK_STATUS, &ps);
+		if (!ps) {
+			ASCLOG(Shader, Info, "Driver rejected cached program binary ", cacheFile, ".");
+			glDeleteProgram(program);
+			return 0;
+		}
+		return program;
+	}
+
+	bool Shader::saveBinary(GLuint program, const std::string& cacheFile,
+		unsigned long long hash) const {
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) {
 			return false;
 		}
-		glDeleteShader(vShader);
-		glDeleteShader(fShader);
-		attributes_.resize(attribSizes.size());
-		stride_ = 0;
-		for (unsigned int a = 0; a < attribSizes.size(); a++) {
-			attributes_[a].size = attribSizes.at(a);
-			attributes_[a].offset = stride_ * sizeof(float);
-			stride_ += attribSizes.at(a);
+		std::vector<char> binary(length);
+		GLenum format = 0;
+		glGetProgramBinary(program, length, 0, &format, &binary[0]);
+		std::ofstream file(cacheFile, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			ASCLOG(Shader, Warning, "Failed to open shader cache ", cacheFile, ".");
+			return false;
 		}
-		stride_ *= sizeof(float);
-		ASCLOG(Shader, Info, "Linked shader program ", ID_, ".");
+		unsigned int version = CACHE_VERSION;
+		unsigned int size = (unsigned int)length;
+		file.write("ASCS", 4);
+		file.write((const char*)&version, sizeof(version));
+		file.write((const char*)&hash, sizeof(hash));
+		file.write((const char*)&format, sizeof(format));
+		file.write((const char*)&size, sizeof(size));
+		file.write(&binary[0], length);
+		if (!file.good()) {
+			ASCLOG(Shader, Warning, "Failed to write shader cache ", cacheFile, ".");
+			return false;
+		}
+		ASCLOG(Shader, Info, "Saved program ", program, " to shader cache ", cacheFile, ".");
 		return true;
 	}
 
-	void Shader::begin() {
-		glUseProgram(ID_);
+	void Shader::begin(unsigned int variant, const Camera* camera) {
+		if (programs_.empty()) {
+			return;
+		}
+		GLuint program = programs_.at(variant < programs_.size() ? variant : 0);
+		glUseProgram(program);
 		for (unsigned int a = 0; a < attributes_.size(); a++) {
 			glVertexAttribPointer(a, attributes_.at(a).size, GL_FLOAT, GL_FALSE, stride_,
 				(void*)attributes_.at(a).offset);
 			glEnableVertexAttribArray(a);
 		}
 		if (!cameraUniform_.empty()) {
-			GLint loc = glGetUniformLocation(ID_, cameraUniform_.c_str());
+			GLint loc = glGetUniformLocation(program, cameraUniform_.c_str());
 			if (loc == -1) {
 				return;
 			}
-			glUniformMatrix4fv(loc, 1, GL_FALSE, &(camera_.getMatrix()[0][0]));
+			const Camera& cam = camera != 0 ? *camera : camera_;
+			glUniformMatrix4fv(loc, 1, GL_FALSE, &(cam.getMatrix()[0][0]));
 		}
 	}
 
@@ -108,9 +254,11 @@ namespace ASC {
 	}
 	
 	void Shader::destroy() {
-		ASCLOG(Shader, Info, "Destroying shader ", ID_, ".");
-		glDeleteProgram(ID_);
-		ID_ = 0;
+		for (GLuint program : programs_) {
+			ASCLOG(Shader, Info, "Destroying shader program ", program, ".");
+			glDeleteProgram(program);
+		}
+		programs_.clear();
 		attributes_.clear();
 		stride_ = 0;
 		cameraUniform_ = "";
@@ -118,9 +266,55 @@ namespace ASC {
 
 	// Define Renderer functions.
 
+	// Fragment shader source shared by the default shader's variants and the culling path.
+	static const char* DEFAULT_FSOURCE =
+		"#version 330 core\n"
+		"in vec2 fTexPos;\n"
+		"in vec3 fColor;\n"
+		"out vec4 FragColor;\n"
+		"uniform sampler2D texSampler;\n"
+		"void main() {\n"
+		"#if defined(GLYPH)\n"
+		"	FragColor = vec4(fColor, texture(texSampler, fTexPos).r);\n"
+		"#elif defined(SOLID)\n"
+		"	FragColor = vec4(fColor, 1.0);\n"
+		"#elif defined(TINTED)\n"
+		"	FragColor = vec4(fColor, 1.0) * texture(texSampler, fTexPos);\n"
+		"#else\n"
+		"	FragColor = texture(texSampler, fTexPos);\n"
+		"#endif\n"
+		"}\n";
+
+	// Source of unique identifiers for renderers' sets of submission queues.
+	static std::atomic<unsigned long long> QUEUE_EPOCHS = 1;
+	// The calling thread's submission queue.
+	static thread_local void* LOCAL_QUEUE = 0;
+	// The identifier of the set of queues the calling thread's queue belongs to.
+	static thread_local unsigned long long LOCAL_EPOCH = 0;
+
 	GLuint Renderer::NO_TEXTURE = 0;
 	Font Renderer::NO_FONT;
 
+	bool Renderer::initLoaders(size_t glyphCacheSize, const std::string& cacheDir) {
+		if (FT_Init_FreeType(&freeType_) != FT_Err_Ok) {
+			ASCLOG(Renderer, Info, "Failed to initialize FreeType library.");
+			return false;
+		}
+		ASCLOG(Renderer, Info, "Initialized FreeType library.");
+		glyphCacheSize_ = glyphCacheSize;
+		cacheDir_ = cacheDir;
+		if (!cacheDir_.empty()) {
+			std::error_code ec;
+			std::filesystem::create_directories(cacheDir_, ec);
+			if (ec) {
+				ASCLOG(Renderer, Warning, "Failed to create cache directory ", cacheDir_, ".");
+				cacheDir_ = "";
+			}
+		}
+		Shader::CACHE_DIR = cacheDir_;
+		return true;
+	}
+
 	bool Renderer::init(const glm::vec3& clearColor) {
 		if (glewInit() != GLEW_OK) {
 			ASCLOG(Renderer, Error, "Failed to initialize GLEW library.");
@@ -128,11 +322,7 @@ namespace ASC {
 		}
 		const GLubyte* version = glGetString(GL_VERSION);
 		ASCLOG(Renderer, Info, "Initialized GLEW library: ", version, ".");
-		if (FT_Init_FreeType(&freeType_) != FT_Err_Ok) {
-			ASCLOG(Renderer, Info, "Failed to initialize FreeType library.");
-			return false;
-		}
-		ASCLOG(Renderer, Info, "Initialized FreeType library.");
+		queueEpoch_ = QUEUE_EPOCHS++;
 		glClearColor(clearColor.x, clearColor.y, clearColor.z, 1.0f);
 		glEnable(GL_BLEND);
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -157,34 +347,91 @@ namespace ASC {
 			"	fColor = vColor;\n"
 			"}\n",
 
-			"#version 330 core\n"
-			"in vec2 fTexPos;\n"
-			"in vec3 fColor;\n"
-			"out vec4 FragColor;\n"
-			"uniform sampler2D texSampler;\n"
-			"void main() {\n"
-			"	if (fColor.x == 0.0 && fColor.y == 0.0 && fColor.z == 0.0) {\n"
-			"		FragColor = texture(texSampler, fTexPos);\n"
-			"	} else {\n"
-			"		vec4 texColor = vec4(1.0, 1.0, 1.0, texture(texSampler, fTexPos).r);\n"
-			"		FragColor = vec4(fColor, 1.0) * texColor;\n"
-			"	}\n"
-			"}\n",
+			DEFAULT_FSOURCE,
 
-			"cameraMatrix", { 3, 2, 3 }
+			"cameraMatrix", { 3, 2, 3 }, { "TEXTURED", "GLYPH", "SOLID", "TINTED" }
 		);
-		ASCLOG(Renderer, Info, "Compiled default shader program.");
+		ASCLOG(Renderer, Info, "Compiled default shader variants.");
 		return true;
 	}
 
 	void Renderer::update(float dt) {
 		defaultShader_.getCamera().update(dt);
+		ticks_++;
 	}
 
-	void Renderer::begin() {
-		glClear(GL_COLOR_BUFFER_BIT);
-		sprites_.clear();
-		glyphs_.clear();
+	void Renderer::begin(float alpha) {
+		alpha_ = alpha;
+		frameThread_ = std::this_thread::get_id();
+		JobMgr::ResetJobKeys();
+		defaultShader_.getCamera().interpolate(alpha);
+		for (View& v : views_) {
+			v.camera->interpolate(alpha);
+		}
+		framePerf_ = perf_;
+		perf_ = 0;
+		frameDrawCalls_ = drawCalls_;
+		drawCalls_ = 0;
+		App::frameArena().flip();
+		clearTarget();
+		batches_.clear();
+		resetQueues();
+		tickText();
+	}
+
+	void Renderer::submit(TextRun& run, Shader& shader) {
+		submit(run, shader, ASC_VARIANT_GLYPH);
+	}
+
+	void Renderer::submit(TextRun& run, Shader& shader, ShaderVariant variant) {
+		if (run.font_ == 0 || !run.font_->isLoaded()) {
+			return;
+		}
+		Batch b;
+		b.shader = &shader;
+		b.variant = variant;
+		b.depth = run.pos_.z;
+		b.run = &run;
+		SubmitQueue& q = getQueue();
+		if (stamp(q, b)) {
+			q.batches.push_back(b);
+		}
+	}
+
+	bool Renderer::stamp(SubmitQueue& q, Batch& b) {
+		if (q.scoped) {
+			b.key = q.key;
+		}
+		else if (JobMgr::GetJobKey() != 0) {
+			b.key = JobMgr::GetJobKey();
+		}
+		else if (std::this_thread::get_id() == frameThread_) {
+			b.key = 0;
+		}
+		else {
+			if (!q.warned) {
+				ASCLOG(Renderer, Warning, "Dropped a submission from a thread without a submit key.");
+				q.warned = true;
+			}
+			return false;
+		}
+		b.overlay = q.overlay;
+		b.order = q.order++;
+		return true;
+	}
+
+	Renderer::SubmitQueue& Renderer::getQueue() {
+		if (LOCAL_QUEUE == 0 || LOCAL_EPOCH != queueEpoch_) {
+			std::scoped_lock lock(queueMtx_);
+			queues_.push_back(std::make_unique<SubmitQueue>());
+			LOCAL_QUEUE = queues_.back().get();
+			LOCAL_EPOCH = queueEpoch_;
+		}
+		return *(SubmitQueue*)LOCAL_QUEUE;
+	}
+
+	void Renderer::submit(TextRun& run) {
+		submit(run, defaultShader_);
 	}
 
 	void Renderer::submit(const std::string& text, const glm::vec3& pos, const glm::vec4& bounds,
@@ -193,264 +440,965 @@ namespace ASC {
 		if (text.empty()) {
 			return;
 		}
-		if (font.glyphs.empty()) {
+		if (!font.isLoaded()) {
 			return;
 		}
-		if (glyphs_.find(&shader) == glyphs_.end()) {
-			glyphs_[&shader] = std::vector<Glyph>(0);
+		TextKey key = { text, &font, scale, hAlign, vAlign, bounds, pos, color };
+		std::unique_lock lock(textMtx_);
+		CachedText& ct = textCache_[key];
+		ct.frame = frame_;
+		ct.run.set(text, pos, bounds, scale, color, font, hAlign, vAlign);
+		lock.unlock();
+		submit(ct.run, shader);
+	}
+
+	void Renderer::submit(const std::string& text, const glm::vec3& pos, const glm::vec4& bounds,
+		float scale, const glm::vec3& color, const Font& font, Alignment hAlign, Alignment vAlign) {
+		submit(text, pos, bounds, scale, color, font, hAlign, vAlign, defaultShader_);
+	}
+
+	bool Renderer::TextKey::operator < (const TextKey& k) const {
+		if (text != k.text) {
+			return text < k.text;
 		}
-		float labelWidth = 0.0f;
-		float minBearing = font.minBearing * scale;
-		float maxBearing = font.maxBearing * scale;
-		for (char c : text) {
-			labelWidth += font.glyphs.at(c).offset * scale;
+		return std::tie(font, scale, hAlign, vAlign, bounds.x, bounds.y, bounds.z, bounds.w,
+			pos.x, pos.y, pos.z, color.x, color.y, color.z)
+			< std::tie(k.font, k.scale, k.hAlign, k.vAlign, k.bounds.x, k.bounds.y, k.bounds.z,
+				k.bounds.w, k.pos.x, k.pos.y, k.pos.z, k.color.x, k.color.y, k.color.z);
+	}
+
+	void Renderer::end() {
+		if (dump_) {
+			ASCLOG(Renderer, Info, "Starting draw, last frame made ", App::frameArena().getFrameAllocations(),
+				" frame arena allocations of ", App::frameArena().getFrameBytes(), " bytes, ",
+				App::frameArena().getFrameOverflows(), " on the heap.");
 		}
-		float labelHeight = minBearing + maxBearing;
-		float x = 0.0f;
-		float y = 0.0f;
-		if (hAlign == ASC_ALIGN_LEFT) {
-			x = bounds.x;
+		batches_.clear();
+		merge(batches_, true);
+		draw(views_, 0);
+	}
+
+	void Renderer::beginPacket(float alpha) {
+		alpha_ = alpha;
+		frameThread_ = std::this_thread::get_id();
+		JobMgr::ResetJobKeys();
+		defaultShader_.getCamera().interpolate(alpha);
+		for (View& v : views_) {
+			v.camera->interpolate(alpha);
 		}
-		else if (hAlign == ASC_ALIGN_RIGHT) {
-			x = (bounds.x + bounds.z) - labelWidth;
+		resetQueues();
+	}
+
+	void Renderer::endPacket() {
+		Packet& p = packets_[1 - front_];
+		p.batches.clear();
+		p.vertices.clear();
+		p.offsets.clear();
+		merge(p.batches, false);
+		for (const Batch& b : p.batches) {
+			p.offsets.push_back(p.vertices.size());
+			if (b.run == 0) {
+				p.vertices.insert(p.vertices.end(), b.vertices, b.vertices + b.size);
+			}
 		}
-		else if (hAlign == ASC_ALIGN_CENTER) {
-			float m = bounds.x + (bounds.z / 2.0f);
-			x = m - (labelWidth / 2.0f);
+		p.camera = defaultShader_.getCamera();
+		p.camera.interpolate(alpha_);
+		p.views = views_;
+		p.cameras.resize(views_.size());
+		for (size_t i = 0; i < views_.size(); i++) {
+			p.cameras[i] = *views_[i].camera;
+			p.cameras[i].interpolate(alpha_);
+			p.views[i].camera = &p.cameras[i];
 		}
-		else {
-			x = pos.x;
+	}
+
+	void Renderer::swapPackets() {
+		front_ = 1 - front_;
+		App::frameArena().flip();
+		tickText();
+		Packet& p = packets_[front_];
+		std::pmr::vector<Batch> batches(&App::frameArena());
+		std::pmr::vector<size_t> offsets(&App::frameArena());
+		batches.reserve(p.batches.size());
+		offsets.reserve(p.batches.size());
+		for (size_t i = 0; i < p.batches.size(); i++) {
+			if (p.batches[i].run == 0) {
+				batches.push_back(p.batches[i]);
+				offsets.push_back(p.offsets[i]);
+				continue;
+			}
+			size_t first = batches.size();
+			layout(p.batches[i], batches);
+			for (size_t j = first; j < batches.size(); j++) {
+				offsets.push_back(p.vertices.size());
+				p.vertices.insert(p.vertices.end(), batches[j].vertices,
+					batches[j].vertices + batches[j].size);
+			}
 		}
-		if (vAlign == ASC_ALIGN_BOTTOM) {
-			y = bounds.y + minBearing;
+		for (size_t i = 0; i < batches.size(); i++) {
+			batches[i].vertices = &p.vertices[offsets[i]];
 		}
-		else if (vAlign == ASC_ALIGN_TOP) {
-			y = (bounds.y + bounds.w) - labelHeight;
+		p.batches.assign(batches.begin(), batches.end());
+	}
+
+	void Renderer::drawPacket() {
+		if (dump_) {
+			ASCLOG(Renderer, Info, "Starting draw of render packet ", front_, ".");
 		}
-		else if (vAlign == ASC_ALIGN_CENTER) {
-			float m = bounds.y + (bounds.w / 2.0f);
-			y = m - (labelHeight / 2.0f);
+		framePerf_ = perf_;
+		perf_ = 0;
+		frameDrawCalls_ = drawCalls_;
+		drawCalls_ = 0;
+		clearTarget();
+		Packet& p = packets_[front_];
+		batches_.swap(p.batches);
+		draw(p.views, &p.camera);
+	}
+
+	void Renderer::resetQueues() {
+		std::scoped_lock lock(queueMtx_);
+		for (std::unique_ptr<SubmitQueue>& q : queues_) {
+			q->batches.clear();
+			q->order = 0;
+			q->key = 0;
+			q->scoped = false;
 		}
-		else {
-			y = pos.y;
+	}
+
+	void Renderer::tickText() {
+		frame_++;
+		for (std::pair<const std::string, Font>& f : fonts_) {
+			f.second.tick();
 		}
-		x -= font.glyphs.at(text.at(0)).bearing.x * scale;
-		for (char c : text) {
-			Glyph g = font.glyphs.at(c);
-			g.init(glm::vec3(x + g.bearing.x * scale, y - ((g.dims.y - g.bearing.y) * scale), pos.z),
-				g.dims * scale, g.texture);
-			if (!(g.pos.x < bounds.x
-				|| g.pos.x + g.dims.x > bounds.x + bounds.z
-				|| g.pos.y < bounds.y
-				|| g.pos.y + g.dims.y > bounds.y + bounds.w)) {
-				g.color = color;
-				g.draw();
-				glyphs_[&shader].push_back(g);
+		std::map<TextKey, CachedText>::iterator it = textCache_.begin();
+		while (it != textCache_.end()) {
+			if (it->second.frame + 1 < frame_) {
+				it = textCache_.erase(it);
+			}
+			else {
+				it++;
 			}
-			x += g.offset * scale;
 		}
 	}
 
-	void Renderer::submit(const std::string& text, const glm::vec3& pos, const glm::vec4& bounds,
-		float scale, const glm::vec3& color, const Font& font, Alignment hAlign, Alignment vAlign) {
-		submit(text, pos, bounds, scale, color, font, hAlign, vAlign, defaultShader_);
+	void Renderer::clearTarget() {
+		if (renderScale_ != 1.0f) {
+			glm::ivec2 dims = glm::max(glm::ivec2(glm::vec2(App::window().getDims()) * renderScale_),
+				glm::ivec2(1));
+			if (FBO_ == 0 || dims != fboDims_) {
+				resizeTarget(dims);
+			}
+			if (FBO_ != 0) {
+				glBindFramebuffer(GL_FRAMEBUFFER, FBO_);
+				glViewport(0, 0, fboDims_.x, fboDims_.y);
+			}
+		}
+		glClear(GL_COLOR_BUFFER_BIT);
 	}
 
-	/*
-	* Compare two sprite structures by their depth.
-	* @param const std::pair<Shader*, Sprite*>& a: The first sprite to test.
-	* @param const std::pair<Shader*, Sprite*>& b: The second sprite to test.
-	* @return Whether sprite a's depth is less then sprite b's.
-	*/
-	bool cmp_sprite_depth(const std::pair<Shader*, Sprite*>& a, const std::pair<Shader*, Sprite*>& b) {
-		if (a.second == 0 || b.second == 0) {
-			return false;
+	void Renderer::merge(std::vector<Batch>& batches, bool layoutText) {
+		ASC_PROFILE_SCOPE("Renderer::merge");
+		{
+			std::scoped_lock lock(queueMtx_);
+			for (std::unique_ptr<SubmitQueue>& q : queues_) {
+				for (const Batch& b : q->batches) {
+					if (b.run == 0 || !layoutText) {
+						batches.push_back(b);
+					}
+					else {
+						layout(b, batches);
+					}
+				}
+				q->batches.clear();
+				q->order = 0;
+			}
+		}
+		if (dump_) {
+			ASCLOG(Renderer, Info, "Merged ", batches.size(), " batches from ", queues_.size(),
+				" submission queues.");
+		}
+		std::stable_sort(batches.begin(), batches.end(), [](const Batch& a, const Batch& b) {
+			return std::tie(a.overlay, a.depth, a.key, a.order)
+				< std::tie(b.overlay, b.depth, b.key, b.order);
+		});
+		if (dump_) {
+			ASCLOG(Renderer, Info, "Sorted ", batches.size(), " batches by depth and submission.");
 		}
-		return a.second->pos.z < b.second->pos.z;
 	}
 
-	void Renderer::end() {
-		if (dump_) {
-			ASCLOG(Renderer, Info, "Starting draw.");
+	template <typename Batches>
+	void Renderer::layout(const Batch& b, Batches& batches) {
+		TextRun& run = *b.run;
+		if (run.dirty_ || run.generation_ != run.font_->getGeneration()) {
+			run.layout();
 		}
-		if (!glyphs_.empty()) {
+		for (const TextRun::Segment& seg : run.segments_) {
+			run.font_->touch(seg.page);
+			Batch t = b;
+			t.run = 0;
+			t.texture = seg.texture;
+			t.vertices = &run.vertices_[seg.first * 4 * Sprite::VERTEX_FLOATS];
+			t.size = seg.quads * 4 * Sprite::VERTEX_FLOATS;
+			t.quads = seg.quads;
+			batches.push_back(t);
+		}
+	}
+
+	void Renderer::draw(const std::vector<View>& views, const Camera* camera) {
+		frameCamera_ = camera;
+		size_t split = std::find_if(batches_.begin(), batches_.end(), [](const Batch& b) {
+			return b.overlay;
+		}) - batches_.begin();
+		glm::ivec2 wd = App::window().getDims();
+		if (FBO_ != 0) {
+			flush(0, split, renderScale_, views);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO_);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			glBlitFramebuffer(0, 0, fboDims_.x, fboDims_.y, 0, 0, wd.x, wd.y, GL_COLOR_BUFFER_BIT,
+				scaleNearest_ ? GL_NEAREST : GL_LINEAR);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glViewport(0, 0, wd.x, wd.y);
 			if (dump_) {
-				ASCLOG(Renderer, Info, "Submitting ", glyphs_.size(), " text glyphs.");
-			}
-			for (std::pair<Shader*, std::vector<Glyph>> p : glyphs_) {
-				submit(glyphs_[p.first], *p.first);
+				ASCLOG(Renderer, Info, "Upscaled ", fboDims_.x, "x", fboDims_.y, " frame to ", wd.x,
+					"x", wd.y, ".");
 			}
 		}
-		if (sprites_.empty()) {
+		else {
+			flush(0, split, 1.0f, views);
+		}
+		if (split < batches_.size()) {
+			flush(split, batches_.size(), 1.0f, std::vector<View>());
+		}
+		frameCamera_ = 0;
+		if (dump_) {
+			dump_ = false;
+		}
+	}
+
+	void Renderer::flush(size_t first, size_t last, float scale, const std::vector<View>& views) {
+		ASC_PROFILE_SCOPE("Renderer::flush");
+		if (first == last) {
 			if (dump_) {
-				ASCLOG(Renderer, Info, "No sprites submitted.");
+				ASCLOG(Renderer, Info, "No sprites submitted to pass.");
 			}
 			return;
 		}
-		std::stable_sort(sprites_.begin(), sprites_.end(), cmp_sprite_depth);
-		if (dump_) {
-			ASCLOG(Renderer, Info, "Sorted sprites by depth.");
+		vertices_.clear();
+		indices_.clear();
+		draws_.clear();
+		unsigned int count = 0;
+		for (size_t i = first; i < last; i++) {
+			const Batch& b = batches_[i];
+			Draw d;
+			d.shader = b.shader;
+			d.variant = b.variant;
+			d.texture = b.texture;
+			d.first = (unsigned int)indices_.size();
+			d.count = b.quads * 6;
+			glm::vec2 lo(b.vertices[0], b.vertices[1]), hi = lo;
+			for (unsigned int v = 0; v < b.size; v += Sprite::VERTEX_FLOATS) {
+				lo = glm::min(lo, glm::vec2(b.vertices[v], b.vertices[v + 1]));
+				hi = glm::max(hi, glm::vec2(b.vertices[v], b.vertices[v + 1]));
+			}
+			d.bounds = glm::vec4(lo, hi - lo);
+			draws_.push_back(d);
+			vertices_.insert(vertices_.end(), b.vertices, b.vertices + b.size);
+			for (unsigned int q = 0; q < b.quads; q++) {
+				for (unsigned int i : Sprite::Indices) {
+					indices_.push_back(i + 4 * count);
+				}
+				count++;
+			}
 		}
 		glBindVertexArray(VAO_);
-		std::vector<float> vertices;
-		std::vector<unsigned int> indices;
-		unsigned int count = 0;
+		glBindBuffer(GL_ARRAY_BUFFER, VBO_);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertices_.size(), vertices_.data(),
+			GL_STREAM_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO_);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * indices_.size(),
+			indices_.data(), GL_STREAM_DRAW);
 		if (dump_) {
-			ASCLOG(Renderer, Info, "Iterating ", sprites_.size(), " sprites.");
+			ASCLOG(Renderer, Info, "Uploaded ", count, " quads in ", draws_.size(), " draws.");
 		}
-		Shader* cShader = sprites_.front().first;
-		cShader->begin();
-		GLuint cTexture = sprites_.front().second->texture;
-		glBindTexture(GL_TEXTURE_2D, cTexture);
-		if (dump_) {
-			ASCLOG(Renderer, Info, "Bound initial shader ", cShader, " and texture ", cTexture, ".");
+		if (gpuCulling_) {
+			groups_.clear();
+			for (const Draw& d : draws_) {
+				if (groups_.empty() || groups_.back().shader != d.shader
+					|| groups_.back().variant != d.variant || groups_.back().texture != d.texture) {
+					Group g;
+					g.shader = d.shader;
+					g.variant = d.variant;
+					g.texture = d.texture;
+					g.firstQuad = d.first / 6;
+					groups_.push_back(g);
+				}
+				groups_.back().quads += d.count / 6;
+			}
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer_);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(unsigned int) * count, 0, GL_STREAM_DRAW);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 		}
-		for (const std::pair<Shader*, Sprite*>& sPair : sprites_) {
-			if (cShader != sPair.first) {
-				if (dump_) {
-					ASCLOG(Renderer, Info, "New shader found ", sPair.first, ".");
+		if (views.empty()) {
+			gpuCulling_ ? drawCulled(0) : drawViews(0);
+		}
+		else {
+			for (const View& v : views) {
+				glm::ivec4 r = glm::ivec4(glm::vec4(v.rect) * scale);
+				glViewport(r.x, r.y, r.z, r.w);
+				gpuCulling_ ? drawCulled(&v) : drawViews(&v);
+			}
+			glm::ivec2 vd = glm::ivec2(glm::vec2(App::window().getDims()) * scale);
+			glViewport(0, 0, vd.x, vd.y);
+		}
+	}
+
+	void Renderer::drawViews(const View* view) {
+		glm::vec4 vb = view != 0 ? view->camera->getBounds() : glm::vec4();
+		const Draw* cDraw = 0;
+		unsigned int first = 0, count = 0, culled = 0, calls = 0;
+		for (const Draw& d : draws_) {
+			if (view != 0 && (d.bounds.x > vb.x + vb.z || d.bounds.x + d.bounds.z < vb.x
+				|| d.bounds.y > vb.y + vb.w || d.bounds.y + d.bounds.w < vb.y)) {
+				culled++;
+				continue;
+			}
+			bool newShader = cDraw == 0 || cDraw->shader != d.shader || cDraw->variant != d.variant;
+			bool newTexture = cDraw == 0 || cDraw->texture != d.texture;
+			if (count > 0 && (newShader || newTexture || first + count != d.first)) {
+				glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT,
+					(void*)(first * sizeof(unsigned int)));
+				calls++;
+				count = 0;
+			}
+			if (newShader) {
+				if (cDraw != 0) {
+					cDraw->shader->end();
 				}
-				if (count > 0) {
-					if (dump_) {
-						ASCLOG(Renderer, Info, "Rendering ", count, " sprites from last shader.");
-					}
-					drawVertices(vertices, indices);
-					count = 0;
+				d.shader->begin(d.variant, view != 0 ? view->camera
+					: (d.shader == &defaultShader_ ? frameCamera_ : 0));
+				if (dump_) {
+					ASCLOG(Renderer, Info, "Bound shader ", d.shader, " variant ", d.variant, ".");
 				}
-				cShader->end();
-				cShader = sPair.first;
-				cShader->begin();
 			}
-			if (cTexture != sPair.second->texture) {
+			if (newTexture) {
+				glBindTexture(GL_TEXTURE_2D, d.texture);
 				if (dump_) {
-					ASCLOG(Renderer, Info, "New texture found ", sPair.second->texture, ".");
-				}
-				if (count > 0) {
-					if (dump_) {
-						ASCLOG(Renderer, Info, "Rendering ", count, " sprites from last texture.");
-					}
-					drawVertices(vertices, indices);
-					count = 0;
+					ASCLOG(Renderer, Info, "Bound texture ", d.texture, ".");
 				}
-				cTexture = sPair.second->texture;
-				glBindTexture(GL_TEXTURE_2D, cTexture);
 			}
-			for (float v : sPair.second->vertices_) {
-				vertices.push_back(v);
+			if (count == 0) {
+				first = d.first;
 			}
-			for (unsigned int i : Sprite::Indices) {
-				indices.push_back(i + 4 * count);
-			}
-			count++;
+			count += d.count;
+			cDraw = &d;
 		}
 		if (count > 0) {
-			if (dump_) {
-				ASCLOG(Renderer, Info, "Drawing ", count, "left over sprites.");
+			glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void*)(first * sizeof(unsigned int)));
+			calls++;
+		}
+		if (cDraw != 0) {
+			cDraw->shader->end();
+		}
+		drawCalls_ += calls;
+		if (dump_) {
+			ASCLOG(Renderer, Info, "Drew view with ", calls, " draw calls, culled ", culled, " of ",
+				draws_.size(), " draws.");
+		}
+	}
+
+	void Renderer::drawCulled(const View* view) {
+		std::pmr::vector<GroupData> data(groups_.size(), &App::frameArena());
+		std::pmr::vector<unsigned int> commands(groups_.size() * 4, &App::frameArena());
+		for (unsigned int g = 0; g < groups_.size(); g++) {
+			data[g].firstQuad = groups_[g].firstQuad;
+			data[g].quads = groups_[g].quads;
+			if (groups_[g].shader != &defaultShader_) {
+				data[g].bounds = glm::vec4(0.0f, 0.0f, -1.0f, -1.0f);
+			}
+			else {
+				data[g].bounds = view != 0 ? view->camera->getBounds()
+					: groups_[g].shader->getCamera().getBounds();
 			}
-			drawVertices(vertices, indices);
+			commands[g * 4 + 1] = 1;
+			commands[g * 4 + 2] = groups_[g].firstQuad * 6;
+		}
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, groupBuffer_);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GroupData) * data.size(), data.data(),
+			GL_STREAM_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer_);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(unsigned int) * commands.size(),
+			commands.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, VBO_);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, visibleBuffer_);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, groupBuffer_);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, commandBuffer_);
+		glUseProgram(cullProgram_);
+		glDispatchCompute((GLuint)groups_.size(), 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+		glUseProgram(0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer_);
+		for (unsigned int g = 0; g < groups_.size(); g++) {
+			const Group& gr = groups_[g];
+			const Camera* camera = view != 0 ? view->camera
+				: (gr.shader == &defaultShader_ ? frameCamera_ : 0);
+			glBindTexture(GL_TEXTURE_2D, gr.texture);
+			if (gr.shader == &defaultShader_) {
+				cullShader_.begin(gr.variant, camera != 0 ? camera : &defaultShader_.getCamera());
+				glDrawArraysIndirect(GL_TRIANGLES, (void*)(g * 4 * sizeof(unsigned int)));
+				cullShader_.end();
+			}
+			else {
+				gr.shader->begin(gr.variant, camera);
+				glDrawElements(GL_TRIANGLES, gr.quads * 6, GL_UNSIGNED_INT,
+					(void*)(gr.firstQuad * 6 * sizeof(unsigned int)));
+				gr.shader->end();
+			}
+			drawCalls_++;
+		}
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		for (unsigned int b = 0; b < 4; b++) {
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, b, 0);
 		}
 		if (dump_) {
-			dump_ = false;
+			ASCLOG(Renderer, Info, "Culled ", vertices_.size() / (4 * Sprite::VERTEX_FLOATS),
+				" quads on the GPU in ", groups_.size(), " groups.");
+		}
+	}
+
+	bool Renderer::setGPUCulling(bool enable) {
+		if (!enable || gpuCulling_) {
+			gpuCulling_ = enable;
+			return gpuCulling_;
+		}
+		if (!GLEW_VERSION_4_3 && !(GLEW_VERSION_4_2 && GLEW_ARB_compute_shader
+			&& GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_multi_draw_indirect)) {
+			ASCLOG(Renderer, Warning, "GPU culling requires OpenGL 4.3 or compute shaders and ",
+				"indirect draws, culling on the CPU.");
+			return false;
+		}
+		std::string renderer = (const char*)glGetString(GL_RENDERER);
+		if (cullProgram_ == 0) {
+			std::string version = GLEW_VERSION_4_3 ? "#version 430 core\n"
+				: "#version 420 core\n"
+				"#extension GL_ARB_compute_shader : require\n"
+				"#extension GL_ARB_shader_storage_buffer_object : require\n";
+			std::string cSource = version +
+				"layout (local_size_x = 256) in;\n"
+				"struct Group { vec4 bounds; uint firstQuad; uint quads; uint padding[2]; };\n"
+				"layout (std430, binding = 0) readonly buffer Quads { float quadData[]; };\n"
+				"layout (std430, binding = 1) writeonly buffer Visible { uint visible[]; };\n"
+				"layout (std430, binding = 2) readonly buffer Groups { Group groups[]; };\n"
+				"layout (std430, binding = 3) buffer Commands { uint commands[]; };\n"
+				"shared uint sums[256];\n"
+				"bool inside(uint q, vec4 b) {\n"
+				"	vec2 lo = vec2(quadData[q * 32u], quadData[q * 32u + 1u]);\n"
+				"	vec2 hi = lo;\n"
+				"	for (uint v = 1u; v < 4u; v++) {\n"
+				"		vec2 p = vec2(quadData[q * 32u + v * 8u], quadData[q * 32u + v * 8u + 1u]);\n"
+				"		lo = min(lo, p);\n"
+				"		hi = max(hi, p);\n"
+				"	}\n"
+				"	return !(hi.x < b.x || lo.x > b.x + b.z || hi.y < b.y || lo.y > b.y + b.w);\n"
+				"}\n"
+				"void main() {\n"
+				"	uint g = gl_WorkGroupID.x;\n"
+				"	uint t = gl_LocalInvocationID.x;\n"
+				"	vec4 b = groups[g].bounds;\n"
+				"	uint first = groups[g].firstQuad;\n"
+				"	uint quads = b.z < 0.0 ? 0u : groups[g].quads;\n"
+				"	uint count = 0u;\n"
+				"	for (uint base = 0u; base < quads; base += 256u) {\n"
+				"		uint q = first + base + t;\n"
+				"		uint keep = base + t < quads && inside(q, b) ? 1u : 0u;\n"
+				"		sums[t] = keep;\n"
+				"		barrier();\n"
+				"		for (uint o = 1u; o < 256u; o <<= 1u) {\n"
+				"			uint add = t >= o ? sums[t - o] : 0u;\n"
+				"			barrier();\n"
+				"			sums[t] += add;\n"
+				"			barrier();\n"
+				"		}\n"
+				"		if (keep == 1u) {\n"
+				"			visible[first + count + sums[t] - 1u] = q;\n"
+				"		}\n"
+				"		count += sums[255];\n"
+				"		barrier();\n"
+				"	}\n"
+				"	if (t == 0u) {\n"
+				"		commands[g * 4u] = count * 6u;\n"
+				"	}\n"
+				"}\n";
+			const char* cSourceC = cSource.c_str();
+			GLuint cShader = glCreateShader(GL_COMPUTE_SHADER);
+			glShaderSource(cShader, 1, &cSourceC, 0);
+			glCompileShader(cShader);
+			int cs;
+			glGetShaderiv(cShader, GL_COMPILE_STATUS, &cs);
+			if (!cs) {
+				char cbuf[512];
+				glGetShaderInfoLog(cShader, 512, 0, cbuf);
+				ASCLOG(Renderer, Warning, "Failed to compile culling shader source.\n", cbuf);
+				glDeleteShader(cShader);
+				return false;
+			}
+			cullProgram_ = glCreateProgram();
+			glAttachShader(cullProgram_, cShader);
+			glLinkProgram(cullProgram_);
+			glDeleteShader(cShader);
+			int ps;
+			glGetProgramiv(cullProgram_, GL_LINK_STATUS, &ps);
+			if (!ps) {
+				ASCLOG(Renderer, Warning, "Failed to link culling shader program.");
+				glDeleteProgram(cullProgram_);
+				cullProgram_ = 0;
+				return false;
+			}
+			std::string fSource = DEFAULT_FSOURCE;
+			fSource.replace(0, fSource.find('\n') + 1, version);
+			bool init = cullShader_.init(version +
+				"layout (std430, binding = 0) readonly buffer Quads { float quadData[]; };\n"
+				"layout (std430, binding = 1) readonly buffer Visible { uint visible[]; };\n"
+				"uniform mat4 cameraMatrix;\n"
+				"out vec2 fTexPos;\n"
+				"out vec3 fColor;\n"
+				"const uint corners[6] = uint[6](0u, 1u, 2u, 2u, 3u, 0u);\n"
+				"void main() {\n"
+				"	uint v = uint(gl_VertexID);\n"
+				"	uint i = visible[v / 6u] * 32u + corners[v % 6u] * 8u;\n"
+				"	vec3 pos = vec3(quadData[i], quadData[i + 1u], quadData[i + 2u]);\n"
+				"	gl_Position = cameraMatrix * vec4(pos, 1.0);\n"
+				"	fTexPos = vec2(quadData[i + 3u], quadData[i + 4u]);\n"
+				"	fColor = vec3(quadData[i + 5u], quadData[i + 6u], quadData[i + 7u]);\n"
+				"}\n",
+
+				fSource,
+
+				"cameraMatrix", {}, { "TEXTURED", "GLYPH", "SOLID", "TINTED" }
+			);
+			if (!init) {
+				ASCLOG(Renderer, Warning, "Failed to compile culled default shader variants.");
+				glDeleteProgram(cullProgram_);
+				cullProgram_ = 0;
+				return false;
+			}
+			glGenBuffers(1, &groupBuffer_);
+			glGenBuffers(1, &visibleBuffer_);
+			glGenBuffers(1, &commandBuffer_);
+			ASCLOG(Renderer, Info, "Compiled GPU culling shader programs.");
+			if (!verifyCulling()) {
+				ASCLOG(Renderer, Warning, "GPU culling gave wrong results on ", renderer,
+					", culling on the CPU.");
+				cullShader_.destroy();
+				glDeleteProgram(cullProgram_);
+				cullProgram_ = 0;
+				glDeleteBuffers(1, &groupBuffer_);
+				glDeleteBuffers(1, &visibleBuffer_);
+				glDeleteBuffers(1, &commandBuffer_);
+				groupBuffer_ = visibleBuffer_ = commandBuffer_ = 0;
+				return false;
+			}
+		}
+		gpuCulling_ = true;
+		return true;
+	}
+
+	bool Renderer::verifyCulling() {
+		// Two quads inside the group's bounds around one outside of them.
+		std::vector<float> quads(3 * 4 * Sprite::VERTEX_FLOATS, 0.0f);
+		for (unsigned int q = 0; q < 3; q++) {
+			for (unsigned int v = 0; v < 4; v++) {
+				float* vertex = &quads[(q * 4 + v) * Sprite::VERTEX_FLOATS];
+				vertex[0] = (q == 1) * 100.0f + q + (v == 1 || v == 2);
+				vertex[1] = (q == 1) * 100.0f + (v >= 2);
+			}
+		}
+		GroupData group;
+		group.bounds = glm::vec4(0.0f, 0.0f, 10.0f, 10.0f);
+		group.quads = 3;
+		unsigned int commands[4] = { 0, 1, 0, 0 };
+		unsigned int visible[3] = { 3, 3, 3 };
+		GLuint quadBuffer = 0;
+		glGenBuffers(1, &quadBuffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, quadBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(float) * quads.size(), quads.data(),
+			GL_STREAM_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, groupBuffer_);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GroupData), &group, GL_STREAM_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer_);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(commands), commands, GL_STREAM_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer_);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(visible), visible, GL_STREAM_DRAW);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, quadBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, visibleBuffer_);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, groupBuffer_);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, commandBuffer_);
+		glUseProgram(cullProgram_);
+		glDispatchCompute(1, 1, 1);
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+		glUseProgram(0);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer_);
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(visible), visible);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer_);
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(commands), commands);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		for (unsigned int b = 0; b < 4; b++) {
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, b, 0);
+		}
+		glDeleteBuffers(1, &quadBuffer);
+		return commands[0] == 12 && visible[0] == 0 && visible[1] == 2;
+	}
+
+	bool Renderer::setDebugOutput(bool enable, GLenum minSeverity,
+		const std::vector<GLenum>& types) {
+		if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug) {
+			ASCLOG(Renderer, Warning, "OpenGL debug output is not supported by this context.");
+			return false;
+		}
+		if (!enable) {
+			glDisable(GL_DEBUG_OUTPUT);
+			glDebugMessageCallback(0, 0);
+			debugOutput_ = false;
+			return false;
+		}
+		GLint flags = 0;
+		glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+		if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) {
+			ASCLOG(Renderer, Warning, "Not a debug context, few debug messages may be reported.");
+		}
+		glEnable(GL_DEBUG_OUTPUT);
+		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		glDebugMessageCallback(DebugCallback, this);
+		const GLenum severities[] = { GL_DEBUG_SEVERITY_HIGH, GL_DEBUG_SEVERITY_MEDIUM,
+			GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_NOTIFICATION };
+		glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, 0, GL_FALSE);
+		for (GLenum sev : severities) {
+			if (types.empty()) {
+				glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, sev, 0, 0, GL_TRUE);
+			}
+			for (GLenum type : types) {
+				glDebugMessageControl(GL_DONT_CARE, type, sev, 0, 0, GL_TRUE);
+			}
+			if (sev == minSeverity) {
+				break;
+			}
+		}
+		debugOutput_ = true;
+		ASCLOG(Renderer, Info, "Enabled OpenGL debug output.");
+		return true;
+	}
+
+	void GLAPIENTRY Renderer::DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+		[[maybe_unused]] GLsizei length, const GLchar* message, const void* userParam) {
+		((Renderer*)userParam)->debugMessage(source, type, id, severity, message);
+	}
+
+	void Renderer::debugMessage(GLenum source, GLenum type, GLuint id, GLenum severity,
+		const char* message) {
+		totalDebug_++;
+		if (type == GL_DEBUG_TYPE_PERFORMANCE) {
+			perf_++;
+			totalPerf_++;
+		}
+		unsigned long long count = ++debugCounts_[std::make_tuple(source, type, id)];
+		unsigned long long log = 1;
+		while (log < count) {
+			log *= 10;
+		}
+		if (log != count) {
+			return;
+		}
+		const char* kind = type == GL_DEBUG_TYPE_ERROR ? "error"
+			: type == GL_DEBUG_TYPE_PERFORMANCE ? "performance"
+			: type == GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR ? "deprecated"
+			: type == GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR ? "undefined behavior"
+			: type == GL_DEBUG_TYPE_PORTABILITY ? "portability" : "other";
+		if (severity == GL_DEBUG_SEVERITY_HIGH || type == GL_DEBUG_TYPE_ERROR) {
+			ASCLOG(Renderer, Error, "OpenGL ", kind, " message ", id, " (x", count, "): ", message);
+		}
+		else if (severity == GL_DEBUG_SEVERITY_NOTIFICATION) {
+			ASCLOG(Renderer, Info, "OpenGL ", kind, " message ", id, " (x", count, "): ", message);
+		}
+		else {
+			ASCLOG(Renderer, Warning, "OpenGL ", kind, " message ", id, " (x", count, "): ", message);
+		}
+	}
+
+	void Renderer::setRenderScale(float scale, bool nearest, bool nativeOverlay) {
+		scale = glm::clamp(scale, 0.1f, 1.0f);
+		renderScale_ = scale;
+		scaleNearest_ = nearest;
+		nativeOverlay_ = nativeOverlay;
+		if (scale == 1.0f && FBO_ != 0) {
+			glDeleteFramebuffers(1, &FBO_);
+			glDeleteTextures(1, &targetTexture_);
+			FBO_ = 0;
+			targetTexture_ = 0;
+			fboDims_ = glm::ivec2();
+		}
+		ASCLOG(Renderer, Info, "Set render scale to ", scale, ".");
+	}
+
+	void Renderer::setOverlay(bool overlay) {
+		getQueue().overlay = overlay && nativeOverlay_ && renderScale_ != 1.0f;
+	}
+
+	void Renderer::resizeTarget(const glm::ivec2& dims) {
+		if (FBO_ == 0) {
+			glGenFramebuffers(1, &FBO_);
+			glGenTextures(1, &targetTexture_);
+		}
+		fboDims_ = dims;
+		glBindTexture(GL_TEXTURE_2D, targetTexture_);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, dims.x, dims.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glBindFramebuffer(GL_FRAMEBUFFER, FBO_);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, targetTexture_,
+			0);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			ASCLOG(Renderer, Warning, "Failed to create ", dims.x, "x", dims.y,
+				" render target, drawing at full resolution.");
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			setRenderScale(1.0f, scaleNearest_, nativeOverlay_);
+			return;
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		ASCLOG(Renderer, Info, "Created ", dims.x, "x", dims.y, " render target.");
+	}
+
+	unsigned int Renderer::addView(const glm::ivec4& rect, Camera& camera) {
+		View v;
+		v.rect = rect;
+		v.camera = &camera;
+		camera.viewDims = glm::ivec2(rect.z, rect.w);
+		camera.init();
+		views_.push_back(v);
+		return (unsigned int)views_.size() - 1;
+	}
+
+	void Renderer::setView(unsigned int view, const glm::ivec4& rect) {
+		if (view >= views_.size()) {
+			return;
 		}
+		views_[view].rect = rect;
+		views_[view].camera->viewDims = glm::ivec2(rect.z, rect.w);
+	}
+
+	void Renderer::clearViews() {
+		views_.clear();
 	}
 
 	const GLuint Renderer::getTexture(const std::string& fileName) {
 		if (textures_.find(fileName) != textures_.end()) {
 			return textures_.at(fileName);
 		}
+		ASC_PROFILE_SCOPE("Renderer::getTexture");
 		ASCLOG(Renderer, Info, "Retrieving texture from ", fileName, ".");
+		DecodedTexture tex;
+		bool preloaded = false;
+		{
+			std::scoped_lock lock(decodeMtx_);
+			std::map<std::string, DecodedTexture>::iterator it = decoded_.find(fileName);
+			if (it != decoded_.end()) {
+				tex = std::move(it->second);
+				decoded_.erase(it);
+				preloaded = true;
+			}
+		}
+		if (!preloaded && !DecodeTexture(fileName, tex)) {
+			return NO_TEXTURE;
+		}
+		GLuint texID = 0;
+		glGenTextures(1, &texID);
+		glBindTexture(GL_TEXTURE_2D, texID);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, tex.w, tex.h, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+			&tex.pixels[0]);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		textures_[fileName] = texID;
+		return texID;
+	}
+
+	bool Renderer::preloadTexture(const std::string& fileName) {
+		{
+			std::scoped_lock lock(decodeMtx_);
+			if (decoded_.find(fileName) != decoded_.end()) {
+				return true;
+			}
+		}
+		ASC_PROFILE_SCOPE("Renderer::preloadTexture");
+		DecodedTexture tex;
+		if (!DecodeTexture(fileName, tex)) {
+			return false;
+		}
+		std::scoped_lock lock(decodeMtx_);
+		decoded_[fileName] = std::move(tex);
+		return true;
+	}
+
+	bool Renderer::DecodeTexture(const std::string& fileName, DecodedTexture& tex) {
 		std::ifstream texFile(fileName, std::ios::in | std::ios::binary | std::ios::ate);
 		if (!texFile.is_open()) {
 			ASCLOG(Renderer, Warning, "Failed to open texture file ", fileName, ".");
-			return NO_TEXTURE;
+			return false;
 		}
 		std::streamsize fSize = 0;
 		if (!texFile.seekg(0, std::ios::end).good()) {
 			ASCLOG(Renderer, Warning, "Failed to read size of texture file ", fileName, ".");
-			return NO_TEXTURE;
+			return false;
 		}
 		fSize = texFile.tellg();
 		if (!texFile.seekg(0, std::ios::beg).good()) {
 			ASCLOG(Renderer, Warning, "Failed to read size of texture file ", fileName, ".");
-			return NO_TEXTURE;
+			return false;
 		}
 		fSize -= texFile.tellg();
 		if (fSize <= 0) {
 			ASCLOG(Renderer, Warning, "Texture file ", fileName, " has invalid size.");
-			return NO_TEXTURE;
+			return false;
 		}
 		std::vector<unsigned char> buffer;
 		buffer.resize((size_t)fSize);
 		texFile.read((char*)(&buffer[0]), fSize);
 		texFile.close();
-		std::vector<unsigned char> texData;
-		unsigned long w = 0, h = 0;
-		if (decodePNG(texData, w, h, &buffer[0], (size_t)fSize) != 0) {
+		if (decodePNG(tex.pixels, tex.w, tex.h, &buffer[0], (size_t)fSize) != 0) {
 			ASCLOG(Renderer, Warning, "Failed to decode PNG from ", fileName, ".");
-			return NO_TEXTURE;
+			return false;
 		}
-		GLuint texID = 0;
-		glGenTextures(1, &texID);
-		glBindTexture(GL_TEXTURE_2D, texID);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, &texData[0]);
-		glBindTexture(GL_TEXTURE_2D, 0);
-		textures_[fileName] = texID;
-		return texID;
+		return true;
 	}
 
 	const Font& Renderer::getFont(const std::string& fileName) {
 		if (fonts_.find(fileName) != fonts_.end()) {
 			return fonts_.at(fileName);
 		}
+		ASC_PROFILE_SCOPE("Renderer::getFont");
 		ASCLOG(Renderer, Info, "Retrieving font ", fileName, ".");
-		FT_Face face;
-		if (FT_New_Face(freeType_, fileName.c_str(), 0, &face) != FT_Err_Ok) {
-			ASCLOG(Renderer, Warning, "Failed to load font file ", fileName, ".");
+		PreparedFont prep;
+		bool preloaded = false;
+		{
+			std::scoped_lock lock(decodeMtx_);
+			std::map<std::string, PreparedFont>::iterator it = prepared_.find(fileName);
+			if (it != prepared_.end()) {
+				prep = std::move(it->second);
+				prepared_.erase(it);
+				preloaded = true;
+			}
+		}
+		if (!preloaded && !readFont(fileName, prep.hash)) {
 			return NO_FONT;
 		}
-		FT_Set_Pixel_Sizes(face, 0, 48);
-		Font font;
-		for (unsigned char g = 0; g < 128; g++) {
-			if (FT_Load_Char(face, g, FT_LOAD_RENDER) != FT_Err_Ok) {
-				ASCLOG(Renderer, Warning, "Failed to load character ", g, " from font ", fileName, ".");
-				continue;
+		Font& font = fonts_[fileName];
+		font.init(freeType_, fileName, FONT_SIZE, glyphCacheSize_);
+		if (!cacheDir_.empty() && font.load(getFontCache(prep.hash), prep.hash)) {
+			if (prep.face != 0) {
+				FT_Done_Face(prep.face);
 			}
-			GLuint texID;
-			glGenTextures(1, &texID);
-			glBindTexture(GL_TEXTURE_2D, texID);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, face->glyph->bitmap.width, face->glyph->bitmap.rows,
-				0, GL_RED, GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
-			font.glyphs[g] = Glyph();
-			font.glyphs[g].dims = glm::vec2(face->glyph->bitmap.width, face->glyph->bitmap.rows);
-			font.glyphs[g].bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
-			font.glyphs[g].offset = face->glyph->advance.x >> 6;
-			font.glyphs[g].texture = texID;
-			float mib = font.glyphs[g].dims.y - (float)font.glyphs[g].bearing.y;
-			if (mib > font.minBearing) {
-				font.minBearing = mib;
-			}
-			float mab = (float)font.glyphs[g].bearing.y;
-			if (mab > font.maxBearing) {
-				font.maxBearing = mab;
-			}
-		}
-		FT_Done_Face(face);
-		fonts_[fileName] = font;
-		return fonts_.at(fileName);
+			return font;
+		}
+		if (!font.open(prep.face)) {
+			ASCLOG(Renderer, Warning, "Failed to load font ", fileName, ".");
+			font.destroy();
+			fonts_.erase(fileName);
+			return NO_FONT;
+		}
+		font.add(prep.glyphs);
+		return font;
+	}
+
+	bool Renderer::preloadFont(const std::string& fileName) {
+		{
+			std::scoped_lock lock(decodeMtx_);
+			if (prepared_.find(fileName) != prepared_.end()) {
+				return true;
+			}
+		}
+		ASC_PROFILE_SCOPE("Renderer::preloadFont");
+		PreparedFont prep;
+		if (!readFont(fileName, prep.hash)) {
+			return false;
+		}
+		std::string cacheFile = getFontCache(prep.hash);
+		std::error_code ec;
+		if ((cacheFile.empty() || !std::filesystem::exists(cacheFile, ec))
+			&& FT_New_Face(freeType_, fileName.c_str(), 0, &prep.face) == FT_Err_Ok) {
+			if (FT_Set_Pixel_Sizes(prep.face, 0, FONT_SIZE) == FT_Err_Ok) {
+				// Render the characters every font is laid out with first.
+				for (unsigned int cp = ' '; cp < Font::HOT_GLYPHS; cp++) {
+					Font::Bitmap bmp;
+					if (Font::Render(prep.face, cp, bmp)) {
+						prep.glyphs.push_back(std::move(bmp));
+					}
+				}
+			}
+			else {
+				FT_Done_Face(prep.face);
+				prep.face = 0;
+			}
+		}
+		std::scoped_lock lock(decodeMtx_);
+		prepared_[fileName] = std::move(prep);
+		return true;
+	}
+
+	bool Renderer::readFont(const std::string& fileName, unsigned long long& hash) const {
+		std::ifstream file(fileName, std::ios::in | std::ios::binary);
+		if (!file.is_open()) {
+			ASCLOG(Renderer, Warning, "Failed to open font file ", fileName, ".");
+			return false;
+		}
+		if (!cacheDir_.empty()) {
+			std::vector<char> data((std::istreambuf_iterator<char>(file)),
+				std::istreambuf_iterator<char>());
+			hash = HashBytes(data.data(), data.size());
+		}
+		return true;
+	}
+
+	std::string Renderer::getFontCache(unsigned long long hash) const {
+		if (cacheDir_.empty()) {
+			return "";
+		}
+		std::stringstream cacheFile;
+		cacheFile << cacheDir_ << "/" << std::hex << std::setw(16) << std::setfill('0') << hash
+			<< std::dec << "_" << FONT_SIZE << ".font";
+		return cacheFile.str();
 	}
 
 	void Renderer::destroy() {
 		ASCLOG(Renderer, Info, "Destroying renderer.");
 		dump_ = false;
-		sprites_.clear();
+		batches_.clear();
+		queues_.clear();
+		queueEpoch_ = QUEUE_EPOCHS++;
+		views_.clear();
+		for (Packet& p : packets_) {
+			p.batches.clear();
+			p.vertices.clear();
+			p.offsets.clear();
+			p.views.clear();
+			p.cameras.clear();
+		}
+		front_ = 0;
+		draws_.clear();
+		vertices_.clear();
+		indices_.clear();
+		textCache_.clear();
+		{
+			std::scoped_lock lock(decodeMtx_);
+			decoded_.clear();
+			for (std::pair<const std::string, PreparedFont>& f : prepared_) {
+				if (f.second.face != 0) {
+					FT_Done_Face(f.second.face);
+				}
+			}
+			prepared_.clear();
+		}
 		unsigned int tCount = 0;
 		for (std::pair<const std::string, GLuint>& t : textures_) {
 			glDeleteTextures(1, &t.second);
@@ -460,10 +1408,8 @@ namespace ASC {
 		textures_.clear();
 		unsigned int fCount = 0;
 		for (std::pair<const std::string, Font>& f : fonts_) {
-			for (std::pair<const char, Glyph>& g : f.second.glyphs) {
-				glDeleteTextures(1, &g.second.texture);
-				g.second.destroy();
-			}
+			f.second.save();
+			f.second.destroy();
 			fCount++;
 		}
 		ASCLOG(Renderer, Info, "Freed ", fCount, " fonts from OpenGL.");
@@ -471,6 +1417,22 @@ namespace ASC {
 		FT_Done_FreeType(freeType_);
 		freeType_ = 0;
 		defaultShader_.destroy();
+		if (cullProgram_ != 0) {
+			cullShader_.destroy();
+			glDeleteProgram(cullProgram_);
+			cullProgram_ = 0;
+			glDeleteBuffers(1, &groupBuffer_);
+			glDeleteBuffers(1, &visibleBuffer_);
+			glDeleteBuffers(1, &commandBuffer_);
+			groupBuffer_ = visibleBuffer_ = commandBuffer_ = 0;
+		}
+		gpuCulling_ = false;
+		setRenderScale(1.0f, false, true);
+		if (debugOutput_) {
+			setDebugOutput(false);
+		}
+		debugCounts_.clear();
+		groups_.clear();
 		glUseProgram(0);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 		glDeleteBuffers(1, &IBO_);
@@ -482,15 +1444,16 @@ namespace ASC {
 		glDeleteVertexArrays(1, &VAO_);
 		VAO_ = 0;
 	}
+	// Define SubmitScope functions.
 
-	void Renderer::drawVertices(std::vector<float>& vertices, std::vector<unsigned int>& indices) {
-		glBindBuffer(GL_ARRAY_BUFFER, VBO_);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO_);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * indices.size(), indices.data(),
-			GL_STATIC_DRAW);
-		glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, (void*)0);
-		vertices.clear();
-		indices.clear();
+	SubmitScope::SubmitScope(Renderer& renderer, unsigned int key) : queue_(renderer.getQueue()),
+		key_(queue_.key), scoped_(queue_.scoped) {
+		queue_.key = key;
+		queue_.scoped = true;
+	}
+
+	SubmitScope::~SubmitScope() {
+		queue_.key = key_;
+		queue_.scoped = scoped_;
 	}
 }
\ No newline at end of file
@@ -10,32 +10,61 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <thread>
 
 #include "Entity.h"
 
 namespace ASC {
-	// Wrapper for OpenGL GLSL vertex/fragment shader program.
+	/*
+	* Hash a block of bytes with 64-bit FNV-1a, used to key on-disk caches.
+	* @param const void* data: The bytes to hash.
+	* @param size_t size: The number of bytes to hash.
+	* @param unsigned long long hash: The hash to continue from.
+	* @return The hash of the bytes.
+	*/
+	unsigned long long HashBytes(const void*, size_t, unsigned long long = 14695981039346656037ULL);
+
+	// Enumeration of variants of the default shader, each compiled with its name defined.
+	enum ShaderVariant {
+		ASC_VARIANT_TEXTURED, ASC_VARIANT_GLYPH, ASC_VARIANT_SOLID, ASC_VARIANT_TINTED,
+		ASC_VARIANT_COUNT,
+	};
+
+	// Wrapper for OpenGL GLSL vertex/fragment shader program and its variants.
 	class Shader {
 	public:
+		// Directory linked programs are cached in, empty to always compile from source.
+		static std::string CACHE_DIR;
+		// Version of the program cache file format, cache files of other versions are ignored.
+		static const unsigned int CACHE_VERSION = 1;
+
 		/*
-		* Assignment operator to copy a shader's ID and camera.
+		* Assignment operator to copy a shader's programs and camera.
 		* @param const Shader& s: The shader to copy.
 		*/
 		void operator = (const Shader&);
 		/*
-		* Compile and initialize this shader.
+		* Load this shader's linked program from the cache or compile and initialize it.
 		* @param const std::string& vSource: The vertex shader source code for this shader.
 		* @param const std::string& fSource: The fragment shader source code for this shader.
 		* @param const std::vector<unsigned int>& attribSizes: The size of each vertex attribute
 		* in this shader program in floats.
+		* @param const std::vector<std::string>& variants: Preprocessor defines to build one
+		* specialized program each from the sources, empty to build a single program.
 		* @return Whether the shader could be compiled and initialized.
 		*/
 		bool init(const std::string&, const std::string&, const std::string&,
-			const std::vector<unsigned int>&);
+			const std::vector<unsigned int>&, const std::vector<std::string>& = {});
 		/*
 		* Tell OpenGL to use this shader and enable its vertex attributes.
+		* @param unsigned int variant: The index of the variant program to use, shaders without
+		* that variant use their first program.
+		* @param const Camera* camera: The camera to use instead of this shader's, 0 for its own.
 		*/
-		void begin();
+		void begin(unsigned int = 0, const Camera* = 0);
 		/*
 		* Tell OpenGL to stop using this shader and disable its vertex attributes.
 		*/
@@ -52,8 +81,8 @@ namespace ASC {
 		}
 
 	private:
-		// The OpenGL program ID for this shader.
-		GLuint ID_ = 0;
+		// The OpenGL program IDs for each variant of this shader.
+		std::vector<GLuint> programs_;
 		// Vertex attribute data structure.
 		struct VAttrib {
 			// The size in bytes of this attribute.
@@ -69,6 +98,29 @@ namespace ASC {
 		Camera camera_;
 		// The name of the mat4 uniform variable for this shader's camera.
 		std::string cameraUniform_ = "";
+
+		/*
+		* Load a program from the cache or compile and link it from source.
+		* @param const std::string& vSource: The vertex shader source code.
+		* @param const std::string& fSource: The fragment shader source code.
+		* @return The linked program ID or 0 on failure.
+		*/
+		GLuint link(const std::string&, const std::string&) const;
+		/*
+		* Create a program from a cached program binary.
+		* @param const std::string& cacheFile: The path to the cache file.
+		* @param unsigned long long hash: The hash of the sources and driver.
+		* @return The program ID or 0 if the binary is missing or rejected by the driver.
+		*/
+		GLuint loadBinary(const std::string&, unsigned long long) const;
+		/*
+		* Write a linked program binary to a cache file.
+		* @param GLuint program: The program to write.
+		* @param const std::string& cacheFile: The path to the cache file.
+		* @param unsigned long long hash: The hash of the sources and driver.
+		* @return Whether the program binary could be written.
+		*/
+		bool saveBinary(GLuint, const std::string&, unsigned long long) const;
 	};
 
 	// App utility for drawing sprites via OpenGL / GLEW.
@@ -78,7 +130,17 @@ namespace ASC {
 		static GLuint NO_TEXTURE;
 		// Empty font returned for errors in getFont() function.
 		static Font NO_FONT;
+		// Height in pixels fonts are rasterized at.
+		static const unsigned int FONT_SIZE = 48;
 
+		/*
+		* Initialize the FreeType library and cache directory, does not need the OpenGL context
+		* so assets can be preloaded while it is created. Must be called before init().
+		* @param size_t glyphCacheSize: The atlas memory in bytes to keep per font.
+		* @param const std::string& cacheDir: The directory to cache fonts and shaders in, empty to disable.
+		* @return Whether FreeType could be initialized.
+		*/
+		bool initLoaders(size_t, const std::string&);
 		/*
 		* Initialize the GLEW library and this renderer's memory.
 		* @param const glm::vec2& clearColor: The background color to clear the window to.
@@ -86,27 +148,147 @@ namespace ASC {
 		*/
 		bool init(const glm::vec3&);
 		/*
-		* Update this renderer's default shader's camera.
+		* Update this renderer's default shader's camera and count the fixed update.
 		* @param float dt: Timestep since last update.
 		*/
 		void update(float);
 		/*
+		* Add a view drawing this renderer's submitted sprites through its own camera, once any
+		* view is added the window is only drawn to through views.
+		* @param const glm::ivec4& rect: The rectangle of the window to draw to in pixels from the
+		* bottom left (x, y, w, h).
+		* @param Camera& camera: The camera to draw through, must stay alive while the view exists.
+		* @return The index of the new view.
+		*/
+		unsigned int addView(const glm::ivec4&, Camera&);
+		/*
+		* Move or resize a view.
+		* @param unsigned int view: The index of the view returned by addView().
+		* @param const glm::ivec4& rect: The new rectangle of the window to draw to (x, y, w, h).
+		*/
+		void setView(unsigned int, const glm::ivec4&);
+		/*
+		* Remove all views, drawing to the whole window through each shader's camera again.
+		*/
+		void clearViews();
+		/*
+		* Enable or disable culling and compacting sprites drawn with the default shader in a
+		* compute shader and drawing them indirectly, requires an OpenGL 4.3 context or 4.2 with
+		* compute shader, storage buffer and indirect draw extensions. Drivers failing a culling
+		* self test keep culling on the CPU. Visible sprites keep their draw order in this mode.
+		* @param bool enable: Whether to cull on the GPU instead of the CPU.
+		* @return Whether GPU culling is now enabled.
+		*/
+		bool setGPUCulling(bool);
+		/*
+		* @return Whether this renderer culls default shader sprites on the GPU.
+		*/
+		inline bool isGPUCulling() const {
+			return gpuCulling_;
+		}
+		/*
 		* Clear the screen and all previous frame data.
+		* @param float alpha: The fraction of a fixed update elapsed since the last one, used to
+		* interpolate the default camera and submitted sprites between updates.
+		*/
+		void begin(float = 1.0f);
+		/*
+		* @return The fraction of a fixed update sprites are interpolated by this frame.
 		*/
-		void begin();
+		inline float getAlpha() const {
+			return alpha_;
+		}
+		/*
+		* @return The number of fixed updates run, entities only interpolate during the frames
+		* after the update they were last updated in.
+		*/
+		inline unsigned long long getTicks() const {
+			return ticks_;
+		}
+		/*
+		* Enable or disable logging OpenGL debug messages, requires a debug context for most
+		* drivers to report anything. Repeated messages are logged at 1, 10, 100... occurrences.
+		* @param bool enable: Whether to log debug messages.
+		* @param GLenum minSeverity: The least severe message to log (GL_DEBUG_SEVERITY_*).
+		* @param const std::vector<GLenum>& types: The message types to log, empty for all types.
+		* @return Whether debug output is now enabled.
+		*/
+		bool setDebugOutput(bool, GLenum = GL_DEBUG_SEVERITY_LOW, const std::vector<GLenum>& = {});
+		/*
+		* @return The number of performance debug messages reported in the last frame.
+		*/
+		inline unsigned int getFramePerfMessages() const {
+			return framePerf_;
+		}
 		/*
-		* Submit a single sprite with a custom shader to this renderer.
+		* @return The number of performance debug messages reported since debug output was enabled.
+		*/
+		inline unsigned long long getTotalPerfMessages() const {
+			return totalPerf_;
+		}
+		/*
+		* @return The number of debug messages reported since debug output was enabled.
+		*/
+		inline unsigned long long getTotalDebugMessages() const {
+			return totalDebug_;
+		}
+		/*
+		* @return The number of OpenGL draw calls made in the last frame.
+		*/
+		inline unsigned int getFrameDrawCalls() const {
+			return frameDrawCalls_;
+		}
+		/*
+		* Set the resolution sprites are drawn at relative to the window, upscaling to the window
+		* in end().
+		* @param float scale: The fraction of the window's resolution to draw at (0.1 to 1).
+		* @param bool nearest: Whether to upscale with nearest filtering instead of linear.
+		* @param bool nativeOverlay: Whether overlay submissions are drawn at native resolution.
+		*/
+		void setRenderScale(float, bool, bool);
+		/*
+		* @return The fraction of the window's resolution sprites are drawn at.
+		*/
+		inline float getRenderScale() const {
+			return renderScale_;
+		}
+		/*
+		* Set whether this thread's following submissions are drawn in a separate pass at the
+		* window's native resolution on top of the scaled scene, only used when drawing at a
+		* reduced render scale with native overlays enabled.
+		* @param bool overlay: Whether to submit to the overlay pass.
+		*/
+		void setOverlay(bool);
+		/*
+		* Submit a single sprite with a custom shader to this renderer, may be called from any
+		* thread between begin() and end().
 		* @param T& sprite: Any sprite type with a draw() function and vertices_ member.
 		* @param Shader& shader: The shader to draw this sprite with.
 		*/
 		template <typename T>
 		void submit(T& sprite, Shader& shader) {
-			sprite.draw();
+			sprite.draw(alpha_);
 			Sprite* s = (Sprite*)&sprite;
 			if (s->vertices_.empty()) {
 				return;
 			}
-			sprites_.push_back(std::pair<Shader*, Sprite*>(&shader, s));
+			Batch b;
+			b.shader = &shader;
+			if (s->texture == 0) {
+				b.variant = ASC_VARIANT_SOLID;
+			}
+			else if (s->color != glm::vec3()) {
+				b.variant = s->tint ? ASC_VARIANT_TINTED : ASC_VARIANT_GLYPH;
+			}
+			b.texture = s->texture;
+			b.depth = s->pos.z;
+			b.vertices = s->vertices_.data();
+			b.size = (unsigned int)s->vertices_.size();
+			b.quads = 1;
+			SubmitQueue& q = getQueue();
+			if (stamp(q, b)) {
+				q.batches.push_back(b);
+			}
 		}
 		/*
 		* Submit a single sprite with the default shader.
@@ -136,7 +318,26 @@ namespace ASC {
 			submit(sprites, defaultShader_);
 		}
 		/*
-		* Submit a string to text to draw with a custom shader.
+		* Submit a run of text with a custom shader, it is laid out in end() if it changed.
+		* @param TextRun& run: The text run to draw, must stay alive until end().
+		* @param Shader& shader: The shader to draw this text with.
+		*/
+		void submit(TextRun&, Shader&);
+		/*
+		* Submit a laid out run of text with a custom shader variant.
+		* @param TextRun& run: The text run to draw, must stay alive until end().
+		* @param Shader& shader: The shader to draw this text with.
+		* @param ShaderVariant variant: The variant of the shader to draw this text with.
+		*/
+		void submit(TextRun&, Shader&, ShaderVariant);
+		/*
+		* Submit a laid out run of text with the default shader.
+		* @param TextRun& run: The text run to draw, must stay alive until end().
+		*/
+		void submit(TextRun&);
+		/*
+		* Submit a string of text to draw with a custom shader, reusing its layout from the
+		* previous frame if nothing changed.
 		* @param const std::string& text: The text to draw.
 		* @param const glm::vec3& pos: The position to start drawing this text at.
 		* @param const glm::vec4& bounds: Rectangle to draw the text inside of (x, y, w, h).
@@ -169,22 +370,62 @@ namespace ASC {
 			dump_ = true;
 		}
 		/*
-		* Draw all sprites submitted since the last call to begin().
+		* Merge each thread's submissions and draw all sprites submitted since the last call to
+		* begin(), ordered by depth, then submit key, then submission order. Neighbouring sprites
+		* with the same shader, variant and texture are drawn together.
 		*/
 		void end();
 		/*
+		* Start submitting a frame into the back render packet instead of drawing it, may be called
+		* from a thread without the OpenGL context while the front packet is drawn.
+		* @param float alpha: The fraction of a fixed update elapsed since the last one, used to
+		* interpolate the default camera and submitted sprites between updates.
+		*/
+		void beginPacket(float = 1.0f);
+		/*
+		* Merge each thread's submissions since beginPacket() into the back render packet, copying
+		* sprite vertices and the cameras they are drawn through so they may change afterwards.
+		*/
+		void endPacket();
+		/*
+		* Make the back render packet the front one and lay out its text, called on the thread
+		* with the OpenGL context while nothing is submitting.
+		*/
+		void swapPackets();
+		/*
+		* Clear the screen and draw the front render packet, called on the thread with the OpenGL
+		* context while the next packet may be submitted.
+		*/
+		void drawPacket();
+		/*
 		* Get an OpenGL texture ID from memory or load the PNG texture.
 		* @param const std::string& fileName: The file path to load the texture from.
 		* @return The ID of the texture retrieved / loaded or NO_TEXTURE.
 		*/
 		const GLuint getTexture(const std::string&);
 		/*
-		* Get a font from memory or load the TTF font.
+		* Read and decode a PNG texture without the OpenGL context, may be called from any thread
+		* so a later getTexture() only has to upload it.
+		* @param const std::string& fileName: The file path to load the texture from.
+		* @return Whether the texture could be read and decoded.
+		*/
+		bool preloadTexture(const std::string&);
+		/*
+		* Get a font from memory, its cache file or open the TTF font, glyphs are rasterized on
+		* first use and cached when this renderer is destroyed.
 		* @param const std::string& fileName: The file path to load the font from.
 		* @return The font retrieved / loaded or NO_FONT.
 		*/
 		const Font& getFont(const std::string&);
 		/*
+		* Read a TTF font and render its leading glyphs without the OpenGL context so a later
+		* getFont() only has to upload them, skipped if it has a cache file. May be called from
+		* another thread while nothing else opens fonts, FreeType is not safe to share.
+		* @param const std::string& fileName: The file path to load the font from.
+		* @return Whether the font file could be read.
+		*/
+		bool preloadFont(const std::string&);
+		/*
 		* Free this renderer's memory.
 		*/
 		void destroy();
@@ -216,19 +457,393 @@ namespace ASC {
 		std::map<std::string, Font> fonts_;
 		// FreeType library instance used to load TTF font files.
 		FT_Library freeType_ = 0;
-		// Set of text characters submitted this frame.
-		std::map<Shader*, std::vector<Glyph>> glyphs_;
-		// Set of sprites submitted this frame.
-		std::vector<std::pair<Shader*, Sprite*>> sprites_;
+		// The atlas memory in bytes to keep per font before evicting unused pages.
+		size_t glyphCacheSize_ = 0;
+		// The directory fonts and shaders are cached in, empty if caching is disabled.
+		std::string cacheDir_ = "";
+		// PNG texture decoded into memory but not yet uploaded.
+		struct DecodedTexture {
+			// The RGBA pixels of the texture.
+			std::vector<unsigned char> pixels;
+			// The width of the texture.
+			unsigned long w = 0;
+			// The height of the texture.
+			unsigned long h = 0;
+		};
+		// Set of textures decoded by preloadTexture() waiting for getTexture().
+		std::map<std::string, DecodedTexture> decoded_;
+		// TTF font read and rendered into memory but not yet uploaded.
+		struct PreparedFont {
+			// The hash of the font file's contents, 0 if caching is disabled.
+			unsigned long long hash = 0;
+			// The face glyphs were rendered with, 0 if the font has a cache file.
+			FT_Face face = 0;
+			// The rendered glyphs.
+			std::vector<Font::Bitmap> glyphs;
+		};
+		// Set of fonts prepared by preloadFont() waiting for getFont().
+		std::map<std::string, PreparedFont> prepared_;
+		// Mutex guarding the decoded textures and prepared fonts.
+		std::mutex decodeMtx_;
+		// Run of quads submitted to this renderer sharing a shader, texture and depth.
+		struct Batch {
+			// The shader to draw these quads with.
+			Shader* shader = 0;
+			// The variant of the shader to draw these quads with.
+			ShaderVariant variant = ASC_VARIANT_TEXTURED;
+			// The texture to draw these quads with.
+			GLuint texture = 0;
+			// The depth to sort these quads by.
+			float depth = 0.0f;
+			// The vertex data of these quads, owned by the submitted sprite or text run.
+			const float* vertices = 0;
+			// The number of floats of vertex data.
+			unsigned int size = 0;
+			// The number of quads in the vertex data.
+			unsigned int quads = 0;
+			// The submit key of the thread that submitted these quads.
+			unsigned long long key = 0;
+			// The index of this batch in its thread's submissions this frame.
+			unsigned long long order = 0;
+			// The text run to lay out into batches in end(), 0 for sprites.
+			TextRun* run = 0;
+			// Whether these quads are drawn in the native resolution overlay pass.
+			bool overlay = false;
+		};
+		// Thread local list of batches submitted by one thread.
+		struct SubmitQueue {
+			// The batches submitted since the last end() call.
+			std::vector<Batch> batches;
+			// The key of the thread's innermost SubmitScope.
+			unsigned long long key = 0;
+			// Whether a SubmitScope is active on the thread.
+			bool scoped = false;
+			// Whether a dropped submission has been logged for this queue.
+			bool warned = false;
+			// The number of batches submitted since the last end() call.
+			unsigned long long order = 0;
+			// Whether batches are submitted to the native resolution overlay pass.
+			bool overlay = false;
+		};
+		// Range of the frame's uploaded indices drawn with one shader, variant and texture.
+		struct Draw {
+			// The shader to draw these indices with.
+			Shader* shader = 0;
+			// The variant of the shader to draw these indices with.
+			ShaderVariant variant = ASC_VARIANT_TEXTURED;
+			// The texture to draw these indices with.
+			GLuint texture = 0;
+			// The offset of the first index in the frame's index buffer.
+			unsigned int first = 0;
+			// The number of indices to draw.
+			unsigned int count = 0;
+			// The world space bounding rectangle of these indices' quads (x, y, w, h).
+			glm::vec4 bounds = glm::vec4();
+		};
+		// Run of draws culled and drawn together on the GPU.
+		struct Group {
+			// The shader to draw this group with.
+			Shader* shader = 0;
+			// The variant of the shader to draw this group with.
+			ShaderVariant variant = ASC_VARIANT_TEXTURED;
+			// The texture to draw this group with.
+			GLuint texture = 0;
+			// The index of this group's first quad in the frame's vertices.
+			unsigned int firstQuad = 0;
+			// The number of quads in this group.
+			unsigned int quads = 0;
+		};
+		// Per group culling data read by the culling compute shader, laid out for std430.
+		struct GroupData {
+			// The world space rectangle to keep quads inside of, negative width to skip.
+			glm::vec4 bounds = glm::vec4();
+			// The index of this group's first quad.
+			unsigned int firstQuad = 0;
+			// The number of quads in this group.
+			unsigned int quads = 0;
+			// Padding to the 16 byte alignment of the struct.
+			unsigned int padding[2] = {};
+		};
+		// Rectangle of the window drawn through a camera.
+		struct View {
+			// The rectangle of the window to draw to in pixels (x, y, w, h).
+			glm::ivec4 rect = glm::ivec4();
+			// The camera to draw through.
+			Camera* camera = 0;
+		};
+		// Snapshot of a frame's submissions handed from the submitting thread to the drawing one.
+		struct Packet {
+			// The frame's sorted batches, pointing into this packet's vertices once swapped in.
+			std::vector<Batch> batches;
+			// Copies of the frame's sprite vertices, and text vertices once swapped in.
+			std::vector<float> vertices;
+			// The offset of each batch's vertices in this packet's vertices.
+			std::vector<size_t> offsets;
+			// The default shader's camera when the frame was submitted.
+			Camera camera;
+			// The frame's views, drawing through this packet's cameras.
+			std::vector<View> views;
+			// Copies of the cameras of the frame's views.
+			std::vector<Camera> cameras;
+		};
+		// Key identifying a text layout submitted by string.
+		struct TextKey {
+			// The text submitted.
+			std::string text;
+			// The font the text was submitted in.
+			const Font* font;
+			// The scale the text was submitted at.
+			float scale;
+			// The horizontal alignment of the text.
+			Alignment hAlign;
+			// The vertical alignment of the text.
+			Alignment vAlign;
+			// The rectangle the text was submitted in.
+			glm::vec4 bounds;
+			// The position the text was submitted at.
+			glm::vec3 pos;
+			// The color the text was submitted in.
+			glm::vec3 color;
+
+			/*
+			* Order text keys for use in a map.
+			* @param const TextKey& k: The key to compare to.
+			* @return Whether this key orders before k.
+			*/
+			bool operator < (const TextKey&) const;
+		};
+		// Text layout cached for strings submitted without a text run.
+		struct CachedText {
+			// The laid out text.
+			TextRun run;
+			// The last frame this text was submitted.
+			unsigned long long frame = 0;
+		};
+		// The number of frames begun by this renderer.
+		unsigned long long frame_ = 0;
+		// Set of text layouts submitted by string in the current or previous frame.
+		std::map<TextKey, CachedText> textCache_;
+		// Set of quads submitted this frame, merged from each thread's queue in end().
+		std::vector<Batch> batches_;
+		// The submission queue of each thread that has submitted to this renderer.
+		std::vector<std::unique_ptr<SubmitQueue>> queues_;
+		// Mutex guarding registration of submission queues.
+		std::mutex queueMtx_;
+		// Mutex guarding the text cache.
+		std::mutex textMtx_;
+		// Identifier of this renderer's current queues, changed when they are freed.
+		unsigned long long queueEpoch_ = 0;
+		// The thread that began the current frame, submitting with key 0 by default.
+		std::thread::id frameThread_;
+		// The set of views to replay the frame's draws through.
+		std::vector<View> views_;
+		// The frame's draws, built once in end() and replayed per view.
+		std::vector<Draw> draws_;
+		// The frame's vertices, uploaded once in end().
+		std::vector<float> vertices_;
+		// The frame's indices, uploaded once in end().
+		std::vector<unsigned int> indices_;
+		// The fraction of the window's resolution sprites are drawn at.
+		float renderScale_ = 1.0f;
+		// The fraction of a fixed update sprites are interpolated by this frame.
+		float alpha_ = 1.0f;
+		// The number of fixed updates run.
+		unsigned long long ticks_ = 0;
+		// The front and back render packets for pipelined drawing.
+		Packet packets_[2];
+		// The index of the render packet being drawn.
+		unsigned int front_ = 0;
+		// The camera to draw the default shader through this frame, 0 for its own.
+		const Camera* frameCamera_ = 0;
+		// Whether scaled frames are upscaled with nearest filtering.
+		bool scaleNearest_ = false;
+		// Whether overlay submissions are drawn at native resolution when scaled.
+		bool nativeOverlay_ = true;
+		// The framebuffer object scaled frames are drawn to, 0 at full resolution.
+		GLuint FBO_ = 0;
+		// The color texture attached to the scaled framebuffer.
+		GLuint targetTexture_ = 0;
+		// The dimensions of the scaled framebuffer.
+		glm::ivec2 fboDims_ = glm::ivec2();
+		// Whether OpenGL debug messages are logged.
+		bool debugOutput_ = false;
+		// The number of times each debug message (source, type, id) has been reported.
+		std::map<std::tuple<GLenum, GLenum, GLuint>, unsigned long long> debugCounts_;
+		// The number of performance debug messages reported in the current frame.
+		unsigned int perf_ = 0;
+		// The number of performance debug messages reported in the last frame.
+		unsigned int framePerf_ = 0;
+		// The number of performance debug messages reported in total.
+		unsigned long long totalPerf_ = 0;
+		// The number of debug messages reported in total.
+		unsigned long long totalDebug_ = 0;
+		// The number of draw calls made in the current frame.
+		unsigned int drawCalls_ = 0;
+		// The number of draw calls made in the last frame.
+		unsigned int frameDrawCalls_ = 0;
+		// Whether sprites drawn with the default shader are culled on the GPU.
+		bool gpuCulling_ = false;
+		// The frame's groups of draws in GPU culling mode.
+		std::vector<Group> groups_;
+		// Compute program culling quads into each group's visible list.
+		GLuint cullProgram_ = 0;
+		// Default shader variants pulling vertices of visible quads from storage buffers.
+		Shader cullShader_;
+		// Storage buffer of each group's culling data.
+		GLuint groupBuffer_ = 0;
+		// Storage buffer of the visible quad indices compacted per group.
+		GLuint visibleBuffer_ = 0;
+		// Indirect draw command buffer with one command per group.
+		GLuint commandBuffer_ = 0;
 		// The default shader to use for this renderer.
 		Shader defaultShader_;
 
 		/*
-		* Draw a set of vertices and indices with OpenGL and clear them.
-		* @param std::vector<float>& vertices: The vertex data to draw.
-		* @param std::vector<unsigned int>& indices: The index data to draw.
+		* Get the calling thread's submission queue, registering a new one on first use.
+		* @return The calling thread's submission queue.
+		*/
+		SubmitQueue& getQueue();
+		/*
+		* Set a batch's submit key, pass and order from the calling thread's queue.
+		* @param SubmitQueue& queue: The calling thread's submission queue.
+		* @param Batch& batch: The batch to submit.
+		* @return Whether the batch has a deterministic key and may be submitted.
+		*/
+		bool stamp(SubmitQueue&, Batch&);
+		/*
+		* Read and decode a PNG texture file.
+		* @param const std::string& fileName: The file path to load the texture from.
+		* @param DecodedTexture& tex: Set to the decoded texture.
+		* @return Whether the texture could be read and decoded.
+		*/
+		static bool DecodeTexture(const std::string&, DecodedTexture&);
+		/*
+		* Check a font file can be read and hash its contents if caching is enabled.
+		* @param const std::string& fileName: The file path of the font.
+		* @param unsigned long long& hash: Set to the hash of the file's contents.
+		* @return Whether the font file could be read.
+		*/
+		bool readFont(const std::string&, unsigned long long&) const;
+		/*
+		* @param unsigned long long hash: The hash of a font file's contents.
+		* @return The path to the font's cache file, empty if caching is disabled.
+		*/
+		std::string getFontCache(unsigned long long) const;
+		/*
+		* Clear each thread's submission queue and submit key.
+		*/
+		void resetQueues();
+		/*
+		* Advance the frame counter, font atlases and text cache.
+		*/
+		void tickText();
+		/*
+		* Bind the scaled framebuffer if required and clear the frame.
 		*/
-		void drawVertices(std::vector<float>&, std::vector<unsigned int>&);
+		void clearTarget();
+		/*
+		* Move each thread's submissions to a list of batches sorted by depth, then submit key,
+		* then submission order.
+		* @param std::vector<Batch>& batches: The list to add the merged batches to.
+		* @param bool layoutText: Whether to lay out text runs into glyph batches now.
+		*/
+		void merge(std::vector<Batch>&, bool);
+		/*
+		* Lay out a text run batch into one batch per atlas page it uses.
+		* @param const Batch& batch: The batch of the text run.
+		* @param Batches& batches: The vector of batches to add the glyph batches to.
+		*/
+		template <typename Batches>
+		void layout(const Batch&, Batches&);
+		/*
+		* Draw the frame's sorted batches, upscaling the scene and drawing the overlay pass.
+		* @param const std::vector<View>& views: The views to draw the scene through.
+		* @param const Camera* camera: The camera to draw the default shader through, 0 for its own.
+		*/
+		void draw(const std::vector<View>&, const Camera*);
+		/*
+		* Forward an OpenGL debug message to the renderer that enabled debug output.
+		* @param const void* userParam: The renderer that enabled debug output.
+		*/
+		static void GLAPIENTRY DebugCallback(GLenum, GLenum, GLuint, GLenum, GLsizei, const GLchar*,
+			const void*);
+		/*
+		* Count and log a message from OpenGL's debug output.
+		* @param GLenum source: The source of the message.
+		* @param GLenum type: The type of the message.
+		* @param GLuint id: The driver's identifier of the message.
+		* @param GLenum severity: The severity of the message.
+		* @param const char* message: The message text.
+		*/
+		void debugMessage(GLenum, GLenum, GLuint, GLenum, const char*);
+		/*
+		* Build, upload and draw a range of the frame's sorted batches.
+		* @param size_t first: The index of the first batch to draw.
+		* @param size_t last: The index after the last batch to draw.
+		* @param float scale: The scale of the target being drawn to relative to the window.
+		* @param const std::vector<View>& views: The views to draw through, empty for none.
+		*/
+		void flush(size_t, size_t, float, const std::vector<View>&);
+		/*
+		* Create or resize the framebuffer scaled frames are drawn to.
+		* @param const glm::ivec2& dims: The dimensions of the framebuffer (w, h).
+		*/
+		void resizeTarget(const glm::ivec2&);
+		/*
+		* Replay the frame's uploaded draws, merging neighbouring draws with the same state.
+		* @param const View* view: The view to cull against and draw through, 0 to draw through
+		* each shader's own camera without culling.
+		*/
+		void drawViews(const View*);
+		/*
+		* Cull the frame's quads on the GPU and draw each group, custom shader groups are drawn
+		* without culling.
+		* @param const View* view: The view to cull against and draw through, 0 to use each
+		* shader's own camera.
+		*/
+		void drawCulled(const View*);
+		/*
+		* Cull a known pair of quads with the culling program and check the result.
+		* @return Whether the driver culled and compacted the quads correctly.
+		*/
+		bool verifyCulling();
+
+		friend class SubmitScope;
+	};
+
+	// Submit key ordering the calling thread's submissions among submissions of the same depth
+	// from other threads until the end of its scope. Without one, submissions from the thread
+	// that began the frame use key 0 and submissions from JobMgr jobs use the job's key, so
+	// the merge in end() is deterministic. Submissions from other threads are dropped.
+	class SubmitScope {
+	public:
+		/*
+		* Submit with a key until this scope ends, each key should only be submitted to by one
+		* thread per frame.
+		* @param Renderer& renderer: The renderer to submit to.
+		* @param unsigned int key: The key to submit with, such as a region index.
+		*/
+		SubmitScope(Renderer&, unsigned int);
+		/*
+		* Restore the thread's previous submit key.
+		*/
+		~SubmitScope();
+		/*
+		* Do not copy submit scopes.
+		*/
+		SubmitScope(const SubmitScope&) = delete;
+		/*
+		* Do not assign submit scopes.
+		*/
+		SubmitScope& operator = (const SubmitScope&) = delete;
+
+	private:
+		// The calling thread's submission queue.
+		Renderer::SubmitQueue& queue_;
+		// The thread's submit key before this scope.
+		unsigned long long key_;
+		// Whether a scope was active on the thread before this one.
+		bool scoped_;
 	};
 }
 
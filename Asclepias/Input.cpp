@@ -29,7 +29,7 @@ namespace ASC {
 		ASCLOG(Input, Info, "Added ", count, " pre-connected controllers.");
 	}
 
-	void InputMgr::update() {
+	void InputMgr::update(double wait) {
 		for (std::pair<const int, std::pair<bool, bool>>& k : keys_) {
 			k.second.second = k.second.first;
 		}
@@ -39,7 +39,14 @@ namespace ASC {
 		}
 		mouseScroll_.second = mouseScroll_.first;
 		mouseScroll_.first = glm::vec2(0.0f, 0.0f);
-		glfwPollEvents();
+		frame_++;
+		events_ = 0;
+		if (wait > 0.0) {
+			glfwWaitEventsTimeout(wait);
+		}
+		else {
+			glfwPollEvents();
+		}
 		while (!removedCtrls_.empty()) {
 			int rc = removedCtrls_.back();
 			removedCtrls_.popBack();
@@ -49,6 +56,13 @@ namespace ASC {
 			}
 		}
 		removedCtrls_.clear();
+		if (replaying_) {
+			for (std::pair<const int, std::pair<GLFWgamepadstate, GLFWgamepadstate>>& c : ctrls_) {
+				c.second.second = c.second.first;
+			}
+			replayFrame();
+			return;
+		}
 		for (std::pair<const int, std::pair<GLFWgamepadstate, GLFWgamepadstate>>& c : ctrls_) {
 			if (!glfwJoystickPresent(c.first)) {
 				continue;
@@ -57,6 +71,7 @@ namespace ASC {
 			glfwGetGamepadState(c.first, &c.second.first);
 			for (int b = 0; b <= GLFW_GAMEPAD_BUTTON_LAST; b++) {
 				if (c.second.first.buttons[b] != c.second.second.buttons[b]) {
+					record(REC_CTRL_BTN, c.first, b, glm::vec2(c.second.first.buttons[b], 0.0f));
 					if (c.second.first.buttons[b] == GLFW_PRESS) {
 						for (InputLstr* lstr : lstrs_) {
 							lstr->ctrlBtnPressed(c.first, b);
@@ -71,6 +86,7 @@ namespace ASC {
 			}
 			for (int a = 0; a <= GLFW_GAMEPAD_AXIS_LAST; a++) {
 				if (c.second.first.axes[a] != c.second.second.axes[a]) {
+					record(REC_CTRL_AXIS, c.first, a, glm::vec2(c.second.first.axes[a], 0.0f));
 					for (InputLstr* lstr : lstrs_) {
 						lstr->ctrlAxisMoved(c.first, a, c.second.first.axes[a]);
 					}
@@ -99,6 +115,9 @@ namespace ASC {
 	}
 
 	void InputMgr::destroy() {
+		stopRecording();
+		replaying_ = false;
+		replay_.clear();
 		lstrs_.clear();
 		keys_.clear();
 		mouseBtns_.clear();
@@ -210,6 +229,100 @@ namespace ASC {
 		return ctrls_.at(ctrl).first.axes[axis];
 	}
 
+	bool InputMgr::startRecording(const std::string& fileName) {
+		if (replaying_ || isRecording()) {
+			return false;
+		}
+		recordFile_.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!recordFile_.is_open()) {
+			ASCLOG(Input, Warning, "Failed to open input recording ", fileName, ".");
+			return false;
+		}
+		unsigned int header[2] = { RECORD_MAGIC, RECORD_VERSION };
+		recordFile_.write((const char*)header, sizeof(header));
+		frame_ = 0;
+		// Controllers connected before recording are replayed as connecting on the first frame.
+		for (const std::pair<const int, std::pair<GLFWgamepadstate, GLFWgamepadstate>>& c : ctrls_) {
+			record(REC_CTRL_CONNECT, c.first);
+			for (int b = 0; b <= GLFW_GAMEPAD_BUTTON_LAST; b++) {
+				if (c.second.first.buttons[b] == GLFW_PRESS) {
+					record(REC_CTRL_BTN, c.first, b, glm::vec2(GLFW_PRESS, 0.0f));
+				}
+			}
+			for (int a = 0; a <= GLFW_GAMEPAD_AXIS_LAST; a++) {
+				if (c.second.first.axes[a] != 0.0f) {
+					record(REC_CTRL_AXIS, c.first, a, glm::vec2(c.second.first.axes[a], 0.0f));
+				}
+			}
+		}
+		ASCLOG(Input, Info, "Recording input to ", fileName, ".");
+		return true;
+	}
+
+	void InputMgr::stopRecording() {
+		if (!isRecording()) {
+			return;
+		}
+		record(REC_END);
+		recordFile_.close();
+		ASCLOG(Input, Info, "Recorded ", frame_, " frames of input.");
+	}
+
+	void InputMgr::recordTicks(unsigned int ticks, float alpha) {
+		record(REC_TICKS, (int)ticks, 0, glm::vec2(alpha, 0.0f));
+	}
+
+	bool InputMgr::startReplay(const std::string& fileName) {
+		if (replaying_ || isRecording()) {
+			return false;
+		}
+		std::ifstream file(fileName, std::ios::in | std::ios::binary);
+		if (!file.is_open()) {
+			ASCLOG(Input, Warning, "Failed to open input recording ", fileName, ".");
+			return false;
+		}
+		unsigned int magic = 0, version = 0;
+		file.read((char*)&magic, sizeof(magic));
+		file.read((char*)&version, sizeof(version));
+		if (!file.good() || magic != RECORD_MAGIC || version != RECORD_VERSION) {
+			ASCLOG(Input, Warning, "Input recording ", fileName, " has an invalid header.");
+			return false;
+		}
+		replay_.clear();
+		RecordEvent e;
+		while (file.read((char*)&e.frame, sizeof(e.frame))
+			&& file.read((char*)&e.type, sizeof(e.type))
+			&& file.read((char*)&e.a, sizeof(e.a))
+			&& file.read((char*)&e.b, sizeof(e.b))
+			&& file.read((char*)&e.v.x, sizeof(e.v.x))
+			&& file.read((char*)&e.v.y, sizeof(e.v.y))) {
+			replay_.push_back(e);
+		}
+		replayPos_ = 0;
+		replayTicks_ = 0;
+		replayAlpha_ = 0.0f;
+		replaying_ = true;
+		replayFinished_ = false;
+		frame_ = 0;
+		// Start from a blank state so only recorded events drive the app.
+		keys_.clear();
+		mouseBtns_.clear();
+		mousePos_ = std::pair<glm::vec2, glm::vec2>();
+		mouseScroll_ = std::pair<glm::vec2, glm::vec2>();
+		ctrls_.clear();
+		ASCLOG(Input, Info, "Replaying ", replay_.size(), " input events from ", fileName, ".");
+		return true;
+	}
+
+	bool InputMgr::getReplayTicks(unsigned int& ticks, float& alpha) const {
+		if (!replaying_ && !replayFinished_) {
+			return false;
+		}
+		ticks = replayTicks_;
+		alpha = replayAlpha_;
+		return true;
+	}
+
 	bool InputMgr::wasKeyDown(int key) const {
 		if (keys_.find(key) == keys_.end()) {
 			return false;
@@ -235,6 +348,7 @@ namespace ASC {
 	}
 
 	void InputMgr::pressKey(int key) {
+		record(REC_KEY_PRESS, key);
 		if (keys_.find(key) == keys_.end()) {
 			keys_[key] = std::pair<bool, bool>(true, false);
 		}
@@ -245,6 +359,7 @@ namespace ASC {
 	}
 
 	void InputMgr::releaseKey(int key) {
+		record(REC_KEY_RELEASE, key);
 		if (keys_.find(key) == keys_.end()) {
 			keys_[key] = std::pair<bool, bool>(false, true);
 		}
@@ -254,13 +369,15 @@ namespace ASC {
 		}
 	}
 
-	void InputMgr::typeChar(char c) {
+	void InputMgr::typeChar(unsigned int cp) {
+		record(REC_CHAR, (int)cp);
 		for (InputLstr* lstr : lstrs_) {
-			lstr->charTyped(c);
+			lstr->charTyped(cp);
 		}
 	}
 
 	void InputMgr::moveMouse(const glm::vec2& pos) {
+		record(REC_MOUSE_MOVE, 0, 0, pos);
 		if (!mouseEnabled_) {
 			return;
 		}
@@ -271,6 +388,7 @@ namespace ASC {
 	}
 
 	void InputMgr::pressMouseBtn(int btn) {
+		record(REC_MOUSE_PRESS, btn);
 		if (!mouseEnabled_) {
 			return;
 		}
@@ -284,6 +402,7 @@ namespace ASC {
 	}
 
 	void InputMgr::releaseMouseBtn(int btn) {
+		record(REC_MOUSE_RELEASE, btn);
 		if (!mouseEnabled_) {
 			return;
 		}
@@ -297,6 +416,7 @@ namespace ASC {
 	}
 
 	void InputMgr::scrollMouse(const glm::vec2& scroll) {
+		record(REC_MOUSE_SCROLL, 0, 0, scroll);
 		if (!mouseEnabled_) {
 			return;
 		}
@@ -316,6 +436,7 @@ namespace ASC {
 		ctrls_[ctrl] = std::pair<GLFWgamepadstate, GLFWgamepadstate>();
 		glfwGetGamepadState(ctrl, &ctrls_[ctrl].first);
 		glfwGetGamepadState(ctrl, &ctrls_[ctrl].second);
+		record(REC_CTRL_CONNECT, ctrl);
 		for (InputLstr* lstr : lstrs_) {
 			lstr->ctrlConnected(ctrl);
 		}
@@ -325,30 +446,137 @@ namespace ASC {
 		if (ctrls_.find(ctrl) == ctrls_.end()) {
 			return;
 		}
+		record(REC_CTRL_DISCONNECT, ctrl);
 		for (InputLstr* lstr : lstrs_) {
 			lstr->ctrlDisconnected(ctrl);
 		}
 		removedCtrls_.pushBack(ctrl);
 	}
 
+	void InputMgr::record(RecordType type, int a, int b, const glm::vec2& v) {
+		if (type != REC_TICKS && type != REC_END) {
+			events_++;
+		}
+		if (!isRecording()) {
+			return;
+		}
+		unsigned char t = (unsigned char)type;
+		recordFile_.write((const char*)&frame_, sizeof(frame_));
+		recordFile_.write((const char*)&t, sizeof(t));
+		recordFile_.write((const char*)&a, sizeof(a));
+		recordFile_.write((const char*)&b, sizeof(b));
+		recordFile_.write((const char*)&v.x, sizeof(v.x));
+		recordFile_.write((const char*)&v.y, sizeof(v.y));
+	}
+
+	void InputMgr::replayFrame() {
+		replayTicks_ = 0;
+		while (replayPos_ < replay_.size() && replay_[replayPos_].frame <= frame_) {
+			const RecordEvent& e = replay_[replayPos_++];
+			switch (e.type) {
+			case REC_KEY_PRESS:
+				pressKey(e.a);
+				break;
+			case REC_KEY_RELEASE:
+				releaseKey(e.a);
+				break;
+			case REC_CHAR:
+				typeChar((unsigned int)e.a);
+				break;
+			case REC_MOUSE_MOVE:
+				moveMouse(e.v);
+				break;
+			case REC_MOUSE_PRESS:
+				pressMouseBtn(e.a);
+				break;
+			case REC_MOUSE_RELEASE:
+				releaseMouseBtn(e.a);
+				break;
+			case REC_MOUSE_SCROLL:
+				scrollMouse(e.v);
+				break;
+			case REC_CTRL_CONNECT:
+				if (ctrls_.find(e.a) == ctrls_.end()) {
+					ctrls_[e.a] = std::pair<GLFWgamepadstate, GLFWgamepadstate>();
+					for (InputLstr* lstr : lstrs_) {
+						lstr->ctrlConnected(e.a);
+					}
+				}
+				break;
+			case REC_CTRL_DISCONNECT:
+				disconnectCtrl(e.a);
+				break;
+			case REC_CTRL_BTN:
+				if (ctrls_.find(e.a) != ctrls_.end() && e.b >= 0 && e.b <= GLFW_GAMEPAD_BUTTON_LAST) {
+					ctrls_[e.a].first.buttons[e.b] = (unsigned char)e.v.x;
+					for (InputLstr* lstr : lstrs_) {
+						if (e.v.x == GLFW_PRESS) {
+							lstr->ctrlBtnPressed(e.a, e.b);
+						}
+						else {
+							lstr->ctrlBtnReleased(e.a, e.b);
+						}
+					}
+				}
+				break;
+			case REC_CTRL_AXIS:
+				if (ctrls_.find(e.a) != ctrls_.end() && e.b >= 0 && e.b <= GLFW_GAMEPAD_AXIS_LAST) {
+					ctrls_[e.a].first.axes[e.b] = e.v.x;
+					for (InputLstr* lstr : lstrs_) {
+						lstr->ctrlAxisMoved(e.a, e.b, e.v.x);
+					}
+				}
+				break;
+			case REC_TICKS:
+				replayTicks_ = (unsigned int)e.a;
+				replayAlpha_ = e.v.x;
+				break;
+			case REC_END:
+				replayPos_ = replay_.size();
+				break;
+			}
+		}
+		if (replayPos_ >= replay_.size()) {
+			replaying_ = false;
+			replayFinished_ = true;
+			ASCLOG(Input, Info, "Finished replaying ", frame_, " frames of input.");
+		}
+	}
+
 	void InputMgr::KeyEvent(GLFWwindow* window, int key, int scancode, int action, int mods) {
+		if (App::input().replaying_) {
+			return;
+		}
 		if (action == GLFW_PRESS) {
 			App::input().pressKey(key);
 		}
 		else if (action == GLFW_RELEASE) {
 			App::input().releaseKey(key);
 		}
+		else if (action == GLFW_REPEAT) {
+			// Repeats change no key state but still wake idle scenes.
+			App::input().events_++;
+		}
 	}
 
 	void InputMgr::CharEvent(GLFWwindow* window, unsigned int codepoint) {
-		App::input().typeChar((char)codepoint);
+		if (App::input().replaying_) {
+			return;
+		}
+		App::input().typeChar(codepoint);
 	}
 
 	void InputMgr::MousePosEvent(GLFWwindow* window, double x, double y) {
+		if (App::input().replaying_) {
+			return;
+		}
 		App::input().moveMouse(glm::vec2(x, App::window().getDims().y - y));
 	}
 
 	void InputMgr::MouseBtnEvent(GLFWwindow* window, int button, int action, int mods) {
+		if (App::input().replaying_) {
+			return;
+		}
 		if (action == GLFW_PRESS) {
 			App::input().pressMouseBtn(button);
 		}
@@ -358,10 +586,16 @@ namespace ASC {
 	}
 
 	void InputMgr::MouseScrollEvent(GLFWwindow* window, double x, double y) {
+		if (App::input().replaying_) {
+			return;
+		}
 		App::input().scrollMouse(glm::vec2(x, y));
 	}
 
 	void InputMgr::CtrlEvent(int jid, int event) {
+		if (App::input().replaying_) {
+			return;
+		}
 		if (event == GLFW_CONNECTED) {
 			App::input().connectCtrl(jid);
 		}
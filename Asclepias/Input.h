@@ -11,6 +11,7 @@
 #include <deque>
 #include <map>
 #include <vector>
+#include <fstream>
 
 #include "Windowing.h"
 
@@ -110,9 +111,9 @@ namespace ASC {
 		virtual void keyReleased(int) {}
 		/*
 		* A character has been typed on the keyboard.
-		* @param char c: The character.
+		* @param unsigned int cp: The Unicode codepoint of the character.
 		*/
-		virtual void charTyped(char) {}
+		virtual void charTyped(unsigned int) {}
 		/*
 		* The mouse cursor has moved on the window.
 		* @param const glm::vec2& mp: The new mouse position.
@@ -282,8 +283,16 @@ namespace ASC {
 		void init();
 		/*
 		* Update this input manager's logic and state.
+		* @param double wait: The longest time in seconds to wait for an event, 0 to only take
+		* events that already arrived.
 		*/
-		void update();
+		void update(double = 0.0);
+		/*
+		* @return Whether any input event arrived in the last update.
+		*/
+		inline bool hadInput() const {
+			return events_ > 0;
+		}
 		/*
 		* Add an input listener to this input manager.
 		* @param InputLstr& lstr: The listener to add.
@@ -444,8 +453,88 @@ namespace ASC {
 		* @return The current controller axis position.
 		*/
 		float getCtrlAxisPos(int, int) const;
+		/*
+		* Start recording every input event with its frame index to a binary file.
+		* @param const std::string& fileName: The file path to record to.
+		* @return Whether the file could be opened, false if replaying.
+		*/
+		bool startRecording(const std::string&);
+		/*
+		* Finish the recording and close its file.
+		*/
+		void stopRecording();
+		/*
+		* @return Whether input events are being recorded.
+		*/
+		inline bool isRecording() const {
+			return recordFile_.is_open();
+		}
+		/*
+		* Record the number of fixed updates and interpolation alpha of the current frame, so a
+		* replay steps the same as the recording.
+		* @param unsigned int ticks: The number of fixed updates this frame.
+		* @param float alpha: The interpolation alpha this frame.
+		*/
+		void recordTicks(unsigned int, float);
+		/*
+		* Replay a recording, ignoring user input and injecting the recorded events on the frames
+		* they happened instead.
+		* @param const std::string& fileName: The file path of the recording.
+		* @return Whether the recording could be read, false if recording.
+		*/
+		bool startReplay(const std::string&);
+		/*
+		* @return Whether a recording is being replayed.
+		*/
+		inline bool isReplaying() const {
+			return replaying_;
+		}
+		/*
+		* @return Whether a replay has reached the end of its recording.
+		*/
+		inline bool isReplayFinished() const {
+			return replayFinished_;
+		}
+		/*
+		* Get the number of fixed updates and interpolation alpha recorded for the current frame.
+		* @param unsigned int& ticks: Set to the recorded number of fixed updates.
+		* @param float& alpha: Set to the recorded interpolation alpha.
+		* @return Whether a replay is running or just finished and set the values.
+		*/
+		bool getReplayTicks(unsigned int&, float&) const;
+		/*
+		* @return The number of updates since recording or replaying started.
+		*/
+		inline unsigned int getFrame() const {
+			return frame_;
+		}
 
 	private:
+		// Types of recorded input events.
+		enum RecordType {
+			REC_KEY_PRESS, REC_KEY_RELEASE, REC_CHAR, REC_MOUSE_MOVE, REC_MOUSE_PRESS,
+			REC_MOUSE_RELEASE, REC_MOUSE_SCROLL, REC_CTRL_CONNECT, REC_CTRL_DISCONNECT,
+			REC_CTRL_BTN, REC_CTRL_AXIS, REC_TICKS, REC_END
+		};
+		// Input event in a recording.
+		struct RecordEvent {
+			// The frame the event happened on.
+			unsigned int frame = 0;
+			// The RecordType of the event.
+			unsigned char type = 0;
+			// The key, button, codepoint, controller or tick count of the event.
+			int a = 0;
+			// The controller button or axis of the event.
+			int b = 0;
+			// The position, scroll, axis position, button state or alpha of the event.
+			glm::vec2 v = glm::vec2(0.0f, 0.0f);
+		};
+
+		// The first bytes of a recording file.
+		static const unsigned int RECORD_MAGIC = 0x49435341;
+		// The version of the recording file format.
+		static const unsigned int RECORD_VERSION = 1;
+
 		// The set of input listeners currently receiving callbacks.
 		std::vector<InputLstr*> lstrs_;
 		// Set of key IDs mapped to their current and previous states.
@@ -464,6 +553,24 @@ namespace ASC {
 		std::map<int, std::pair<GLFWgamepadstate, GLFWgamepadstate>> ctrls_;
 		// Set of game controllers to remove from memory on the next update.
 		TSQueue<int> removedCtrls_;
+		// The number of input events in the last update.
+		unsigned int events_ = 0;
+		// The number of updates since recording or replaying started.
+		unsigned int frame_ = 0;
+		// The file input events are recorded to, closed if not recording.
+		std::ofstream recordFile_;
+		// Whether a recording is being replayed.
+		bool replaying_ = false;
+		// Whether a replay has reached the end of its recording.
+		bool replayFinished_ = false;
+		// The events of the recording being replayed.
+		std::vector<RecordEvent> replay_;
+		// The index of the next event to replay.
+		size_t replayPos_ = 0;
+		// The number of fixed updates recorded for the current frame.
+		unsigned int replayTicks_ = 0;
+		// The interpolation alpha recorded for the current frame.
+		float replayAlpha_ = 0.0f;
 
 		/*
 		* Determine whether a keyboard key was down in the last update.
@@ -496,9 +603,9 @@ namespace ASC {
 		void releaseKey(int);
 		/*
 		* Notify input listeners of a character typed on the keyboard.
-		* @param char c: The character typed.
+		* @param unsigned int cp: The Unicode codepoint of the character typed.
 		*/
-		void typeChar(char);
+		void typeChar(unsigned int);
 		/*
 		* Change the mouse cursor's current position and notify input listeners.
 		* @param const glm::vec2& mp: The new position of the mouse.
@@ -530,6 +637,18 @@ namespace ASC {
 		*/
 		void disconnectCtrl(int);
 		/*
+		* Count an input event and write it to the recording if recording.
+		* @param RecordType type: The type of the event.
+		* @param int a: The key, button, codepoint, controller or tick count of the event.
+		* @param int b: The controller button or axis of the event.
+		* @param const glm::vec2& v: The position, scroll, axis position, button state or alpha.
+		*/
+		void record(RecordType, int = 0, int = 0, const glm::vec2& = glm::vec2(0.0f, 0.0f));
+		/*
+		* Inject the recorded events of the current frame through the same paths as user input.
+		*/
+		void replayFrame();
+		/*
 		* GLFW callback for keyboard key events.
 		* @param GLFWwindow* window: The GLFW window handle to listen on.
 		* @param int key: The key ID.
@@ -541,7 +660,7 @@ namespace ASC {
 		/*
 		* GLFW callback for keyboard typing events.
 		* @param GLFWwindow* window: The GLFW window handle to listen on.
-		* @param unsigned int codepoint: The ASCII character typed.
+		* @param unsigned int codepoint: The Unicode codepoint of the character typed.
 		*/
 		static void CharEvent(GLFWwindow*, unsigned int);
 		/*
@@ -0,0 +1,191 @@
+/*
+* File:		Jobs.cpp
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.07
+*/
+
+#include "Asclepias.h"
+
+namespace ASC {
+	// Define JobMgr functions.
+
+	thread_local JobMgr* JobMgr::LOCAL_MGR = 0;
+	thread_local unsigned int JobMgr::LOCAL_WORKER = 0;
+	thread_local unsigned long long JobMgr::LOCAL_KEY = 0;
+	thread_local unsigned long long JobMgr::LOCAL_SUBMITS = 0;
+
+	unsigned int JobMgr::GetDefaultWorkers() {
+		unsigned int threads = std::thread::hardware_concurrency();
+		return threads > 1 ? threads - 1 : 1;
+	}
+
+	void JobMgr::init(unsigned int workers) {
+		stop_ = false;
+		next_ = 0;
+		pending_ = 0;
+		steals_ = 0;
+		for (unsigned int i = 0; i < workers; i++) {
+			workers_.push_back(std::make_unique<Worker>());
+		}
+		for (unsigned int i = 0; i < workers; i++) {
+			workers_[i]->thread = std::thread(&JobMgr::work, this, i);
+		}
+	}
+
+	void JobMgr::destroy() {
+		{
+			std::scoped_lock lock(sleepMtx_);
+			stop_ = true;
+		}
+		sleepCv_.notify_all();
+		for (std::unique_ptr<Worker>& w : workers_) {
+			if (w->thread.joinable()) {
+				w->thread.join();
+			}
+		}
+		workers_.clear();
+	}
+
+	void JobMgr::submit(Job job, JobCounter* counter, JobCounter* after) {
+		Task t;
+		t.job = std::move(job);
+		t.counter = counter;
+		t.key = NextKey();
+		if (counter != 0) {
+			counter->value_.fetch_add(1, std::memory_order_relaxed);
+		}
+		if (after != 0) {
+			std::scoped_lock lock(after->mtx_);
+			if (after->value_.load(std::memory_order_acquire) > 0) {
+				after->waiting_.emplace_back(std::move(t.job), t.counter, t.key);
+				return;
+			}
+		}
+		push(std::move(t));
+	}
+
+	void JobMgr::wait(JobCounter& counter) {
+		unsigned int self = LOCAL_MGR == this ? LOCAL_WORKER : getWorkers();
+		Task t;
+		while (!counter.done()) {
+			if (pop(self, t)) {
+				run(t);
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+		// Let the thread that finished the last job release the counter.
+		std::scoped_lock lock(counter.mtx_);
+	}
+
+	unsigned long long JobMgr::NextKey() {
+		unsigned long long index = ++LOCAL_SUBMITS;
+		if (LOCAL_KEY == 0) {
+			return KEY_BIT | index;
+		}
+		// Mix the submitting job's key with the index for jobs submitted by jobs.
+		unsigned long long h = LOCAL_KEY + index * 0x9E3779B97F4A7C15ull;
+		h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+		h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+		return KEY_BIT | (h ^ (h >> 31));
+	}
+
+	void JobMgr::push(Task&& task) {
+		if (workers_.empty()) {
+			run(task);
+			return;
+		}
+		unsigned int w = LOCAL_MGR == this ? LOCAL_WORKER
+			: next_.fetch_add(1, std::memory_order_relaxed) % getWorkers();
+		{
+			std::scoped_lock lock(workers_[w]->mtx);
+			pending_.fetch_add(1, std::memory_order_release);
+			workers_[w]->tasks.push_back(std::move(task));
+		}
+		{
+			std::scoped_lock lock(sleepMtx_);
+		}
+		sleepCv_.notify_one();
+	}
+
+	bool JobMgr::pop(unsigned int self, Task& task) {
+		if (pending_.load(std::memory_order_acquire) == 0) {
+			return false;
+		}
+		if (self < workers_.size()) {
+			Worker& w = *workers_[self];
+			std::scoped_lock lock(w.mtx);
+			if (!w.tasks.empty()) {
+				task = std::move(w.tasks.back());
+				w.tasks.pop_back();
+				pending_.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		for (unsigned int i = 1; i <= workers_.size(); i++) {
+			Worker& w = *workers_[(self + i) % workers_.size()];
+			std::scoped_lock lock(w.mtx);
+			if (!w.tasks.empty()) {
+				task = std::move(w.tasks.front());
+				w.tasks.pop_front();
+				pending_.fetch_sub(1, std::memory_order_relaxed);
+				steals_.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void JobMgr::run(Task& task) {
+		{
+			ASC_PROFILE_SCOPE("JobMgr::run");
+			unsigned long long key = LOCAL_KEY, submits = LOCAL_SUBMITS;
+			LOCAL_KEY = task.key;
+			LOCAL_SUBMITS = 0;
+			task.job();
+			LOCAL_KEY = key;
+			LOCAL_SUBMITS = submits;
+		}
+		task.job = nullptr;
+		JobCounter* counter = task.counter;
+		if (counter == 0) {
+			return;
+		}
+		std::vector<std::tuple<Job, JobCounter*, unsigned long long>> ready;
+		{
+			std::scoped_lock lock(counter->mtx_);
+			if (counter->value_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				ready.swap(counter->waiting_);
+			}
+		}
+		for (std::tuple<Job, JobCounter*, unsigned long long>& r : ready) {
+			Task t;
+			t.job = std::move(std::get<0>(r));
+			t.counter = std::get<1>(r);
+			t.key = std::get<2>(r);
+			push(std::move(t));
+		}
+	}
+
+	void JobMgr::work(unsigned int index) {
+		LOCAL_MGR = this;
+		LOCAL_WORKER = index;
+		ASC_PROFILE_THREAD("Job worker " + std::to_string(index));
+		Task t;
+		while (true) {
+			if (pop(index, t)) {
+				run(t);
+				continue;
+			}
+			std::unique_lock lock(sleepMtx_);
+			sleepCv_.wait(lock, [this]() {
+				return stop_ || pending_.load(std::memory_order_acquire) > 0;
+			});
+			if (stop_ && pending_.load(std::memory_order_acquire) == 0) {
+				break;
+			}
+		}
+		LOCAL_MGR = 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,222 @@
+/*
+* File:		Jobs.h
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.07
+*/
+
+#ifndef ASC_JOBS_H
+#define ASC_JOBS_H
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <tuple>
+
+namespace ASC {
+	// Count of unfinished jobs that threads can wait on and other jobs can depend on.
+	class JobCounter {
+	public:
+		/*
+		* @return Whether every job submitted with this counter has finished.
+		*/
+		inline bool done() const {
+			return value_.load(std::memory_order_acquire) == 0;
+		}
+		/*
+		* @return The number of unfinished jobs submitted with this counter.
+		*/
+		inline unsigned int get() const {
+			return value_.load(std::memory_order_acquire);
+		}
+
+	private:
+		friend class JobMgr;
+
+		// The number of unfinished jobs.
+		std::atomic<unsigned int> value_ = 0;
+		// Mutex guarding the jobs waiting on this counter.
+		std::mutex mtx_;
+		// Jobs to start once this counter reaches zero, with the counters they signal and keys.
+		std::vector<std::tuple<std::function<void()>, JobCounter*, unsigned long long>> waiting_;
+	};
+
+	// Work stealing thread pool that the main thread helps while waiting on it.
+	class JobMgr {
+	public:
+		// A unit of work run on any worker thread.
+		typedef std::function<void()> Job;
+
+		/*
+		* @return The number of workers to start so every hardware thread runs jobs, counting the
+		* thread waiting on them.
+		*/
+		static unsigned int GetDefaultWorkers();
+		/*
+		* Initialize this job manager's memory and start its worker threads.
+		* @param unsigned int workers: The number of worker threads to start, 0 to run every job
+		* on the threads that wait for them.
+		*/
+		void init(unsigned int);
+		/*
+		* Finish all queued jobs and stop the worker threads.
+		*/
+		void destroy();
+		/*
+		* Queue a job on the calling worker's deque, or spread across workers from other threads.
+		* The job is keyed by its submission index on the calling thread, and by the key of the
+		* job submitting it, so the same submissions get the same keys every run.
+		* @param Job job: The job to run.
+		* @param JobCounter* counter: The counter to count the job in until it finishes, 0 for none.
+		* @param JobCounter* after: The counter to wait for before the job may start, 0 for none.
+		*/
+		void submit(Job, JobCounter* = 0, JobCounter* = 0);
+		/*
+		* Run queued jobs on the calling thread until every job counted by a counter has finished,
+		* the counter may be destroyed once this returns.
+		* @param JobCounter& counter: The counter to wait for.
+		*/
+		void wait(JobCounter&);
+		/*
+		* Call a function for each index of a range, split into jobs of consecutive indices and
+		* waited on by the calling thread. Each job is keyed like a submit() call.
+		* @param unsigned int first: The first index.
+		* @param unsigned int last: The index after the last index.
+		* @param F func: The function to call with each index.
+		* @param unsigned int grain: The number of indices per job, 0 to split the range into a
+		* few jobs per thread.
+		*/
+		template <typename F>
+		void parallelFor(unsigned int first, unsigned int last, F func, unsigned int grain = 0) {
+			if (last <= first) {
+				return;
+			}
+			if (grain == 0) {
+				grain = (std::max)((last - first) / (4 * (getWorkers() + 1)), 1u);
+			}
+			if (last - first <= grain) {
+				for (unsigned int i = first; i < last; i++) {
+					func(i);
+				}
+				return;
+			}
+			JobCounter counter;
+			for (unsigned int b = first; b < last; b += (std::min)(grain, last - b)) {
+				unsigned int e = b + (std::min)(grain, last - b);
+				submit([&func, b, e]() {
+					for (unsigned int i = b; i < e; i++) {
+						func(i);
+					}
+				}, &counter);
+			}
+			wait(counter);
+		}
+		/*
+		* @return The key of the job the calling thread is running, 0 outside of one. Keys have
+		* the high bit set and differ between every job submitted since the last ResetJobKeys().
+		*/
+		inline static unsigned long long GetJobKey() {
+			return LOCAL_KEY;
+		}
+		/*
+		* Restart the calling thread's submission index, so each frame keys its jobs from 1 again.
+		*/
+		inline static void ResetJobKeys() {
+			LOCAL_SUBMITS = 0;
+		}
+		/*
+		* @return The number of worker threads running jobs.
+		*/
+		inline unsigned int getWorkers() const {
+			return (unsigned int)workers_.size();
+		}
+		/*
+		* @return The number of jobs taken from another worker's deque since initialization.
+		*/
+		inline unsigned long long getSteals() const {
+			return steals_.load(std::memory_order_relaxed);
+		}
+
+	private:
+		// Queued job with the counter it signals.
+		struct Task {
+			// The job to run.
+			Job job;
+			// The counter to signal once the job finishes, 0 for none.
+			JobCounter* counter = 0;
+			// The key the job runs with.
+			unsigned long long key = 0;
+		};
+		// Worker thread with its own deque of jobs.
+		struct Worker {
+			// The worker's jobs, popped from the back by the worker and stolen from the front.
+			std::deque<Task> tasks;
+			// Mutex guarding the worker's jobs.
+			std::mutex mtx;
+			// The worker's thread.
+			std::thread thread;
+		};
+
+		// The manager the calling thread is a worker of, 0 for other threads.
+		static thread_local JobMgr* LOCAL_MGR;
+		// The index of the calling thread's worker.
+		static thread_local unsigned int LOCAL_WORKER;
+		// The bit set in every job key, keeping them apart from other keys.
+		static const unsigned long long KEY_BIT = 1ull << 63;
+
+		// The key of the job the calling thread is running, 0 for none.
+		static thread_local unsigned long long LOCAL_KEY;
+		// The number of jobs submitted by the calling thread or its running job.
+		static thread_local unsigned long long LOCAL_SUBMITS;
+
+		// The worker threads.
+		std::vector<std::unique_ptr<Worker>> workers_;
+		// The next worker to queue jobs from other threads on.
+		std::atomic<unsigned int> next_ = 0;
+		// The number of queued jobs not yet taken by a thread.
+		std::atomic<unsigned int> pending_ = 0;
+		// The number of jobs stolen from other workers.
+		std::atomic<unsigned long long> steals_ = 0;
+		// Mutex guarding idle workers sleeping.
+		std::mutex sleepMtx_;
+		// Condition signalled when jobs are queued or the workers should stop.
+		std::condition_variable sleepCv_;
+		// Whether the workers should stop once the queued jobs are done.
+		bool stop_ = false;
+
+		/*
+		* @return The key of the next job submitted by the calling thread.
+		*/
+		static unsigned long long NextKey();
+		/*
+		* Queue a ready job on a worker's deque and wake an idle worker.
+		* @param Task&& task: The job to queue.
+		*/
+		void push(Task&&);
+		/*
+		* Take a job from a worker's own deque or steal one from another worker.
+		* @param unsigned int self: The index of the calling worker, or the number of workers for
+		* other threads.
+		* @param Task& task: Set to the job taken.
+		* @return Whether a job was taken.
+		*/
+		bool pop(unsigned int, Task&);
+		/*
+		* Run a job with its key and signal its counter.
+		* @param Task& task: The job to run.
+		*/
+		void run(Task&);
+		/*
+		* Run and steal jobs until stopped, run on each worker thread.
+		* @param unsigned int index: The index of this worker.
+		*/
+		void work(unsigned int);
+	};
+}
+
+#endif
\ No newline at end of file
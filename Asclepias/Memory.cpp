@@ -0,0 +1,86 @@
+/*
+* File:		Memory.cpp
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.07
+*/
+
+#include <new>
+
+#include "Asclepias.h"
+
+namespace ASC {
+	// Define FrameArena functions.
+
+	void FrameArena::init(size_t size) {
+		for (Buffer& b : buffers_) {
+			b.data = std::make_unique<unsigned char[]>(size);
+			b.size = size;
+			b.used = 0;
+		}
+		current_ = 0;
+	}
+
+	void FrameArena::flip() {
+		frameAllocations_ = allocations_.exchange(0, std::memory_order_relaxed);
+		frameBytes_ = bytes_.exchange(0, std::memory_order_relaxed);
+		frameOverflows_ = overflows_.exchange(0, std::memory_order_relaxed);
+		current_ = 1 - current_;
+		reset(buffers_[current_]);
+	}
+
+	void FrameArena::destroy() {
+		for (Buffer& b : buffers_) {
+			reset(b);
+			b.data.reset();
+			b.size = 0;
+		}
+		current_ = 0;
+		allocations_ = 0;
+		bytes_ = 0;
+		overflows_ = 0;
+		frameAllocations_ = 0;
+		frameBytes_ = 0;
+		frameOverflows_ = 0;
+	}
+
+	void* FrameArena::do_allocate(size_t bytes, size_t align) {
+		allocations_.fetch_add(1, std::memory_order_relaxed);
+		bytes_.fetch_add(bytes, std::memory_order_relaxed);
+		Buffer& b = buffers_[current_];
+		bytes = bytes > 0 ? bytes : 1;
+		if (align <= alignof(std::max_align_t)) {
+			size_t used = b.used.load(std::memory_order_relaxed);
+			while (true) {
+				size_t start = (used + align - 1) & ~(align - 1);
+				if (start + bytes > b.size) {
+					break;
+				}
+				if (b.used.compare_exchange_weak(used, start + bytes, std::memory_order_relaxed)) {
+					return b.data.get() + start;
+				}
+			}
+		}
+		overflows_.fetch_add(1, std::memory_order_relaxed);
+		void* data = ::operator new(bytes, std::align_val_t(align));
+		std::scoped_lock lock(mtx_);
+		b.overflows.push_back({ data, align });
+		b.overflowBytes += bytes;
+		return data;
+	}
+
+	void FrameArena::reset(Buffer& b) {
+		for (const Overflow& o : b.overflows) {
+			::operator delete(o.data, std::align_val_t(o.align));
+		}
+		b.overflows.clear();
+		if (b.overflowBytes > 0 && b.data) {
+			// Grow to the frame's peak so later frames like it stay in the buffer.
+			size_t size = std::max(b.size * 2, b.size + b.overflowBytes);
+			b.data = std::make_unique<unsigned char[]>(size);
+			b.size = size;
+			ASCLOG(FrameArena, Info, "Grew frame arena buffer to ", size / 1024, " KB.");
+		}
+		b.overflowBytes = 0;
+		b.used.store(0, std::memory_order_relaxed);
+	}
+}
\ No newline at end of file
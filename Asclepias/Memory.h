@@ -0,0 +1,143 @@
+/*
+* File:		Memory.h
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.07
+*/
+
+#ifndef ASC_MEMORY_H
+#define ASC_MEMORY_H
+
+#include <memory_resource>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+namespace ASC {
+	// Double-buffered linear allocator for transient data, which lives until the end of the frame
+	// after the one it was allocated in and is then freed at once by reusing its buffer. Use it
+	// through std::pmr containers, it may be allocated from on any thread.
+	class FrameArena : public std::pmr::memory_resource {
+	public:
+		/*
+		* Construct an empty frame arena.
+		*/
+		FrameArena() = default;
+		/*
+		* Do not copy frame arenas, they own their buffers.
+		*/
+		FrameArena(const FrameArena&) = delete;
+		/*
+		* Do not assign frame arenas, they own their buffers.
+		*/
+		FrameArena& operator = (const FrameArena&) = delete;
+		/*
+		* Initialize this arena's buffers.
+		* @param size_t size: The initial size in bytes of each buffer, grown to fit a frame's peak.
+		*/
+		void init(size_t);
+		/*
+		* Start a new frame, freeing the data allocated two frames ago. Call while nothing allocates.
+		*/
+		void flip();
+		/*
+		* Free this arena's buffers.
+		*/
+		void destroy();
+		/*
+		* @return The number of allocations made in the last frame.
+		*/
+		inline unsigned int getFrameAllocations() const {
+			return frameAllocations_;
+		}
+		/*
+		* @return The number of bytes allocated in the last frame.
+		*/
+		inline size_t getFrameBytes() const {
+			return frameBytes_;
+		}
+		/*
+		* @return The number of allocations in the last frame that did not fit in the buffer and
+		* went to the heap.
+		*/
+		inline unsigned int getFrameOverflows() const {
+			return frameOverflows_;
+		}
+		/*
+		* @return The size in bytes of the current frame's buffer.
+		*/
+		inline size_t getSize() const {
+			return buffers_[current_].size;
+		}
+
+	protected:
+		/*
+		* Bump allocate from the current frame's buffer, or the heap if it is full.
+		* @param size_t bytes: The size in bytes to allocate.
+		* @param size_t align: The alignment of the allocation.
+		* @return The allocated memory.
+		*/
+		void* do_allocate(size_t, size_t) override;
+		/*
+		* Do nothing, memory is freed when its buffer is reused.
+		*/
+		inline void do_deallocate(void*, size_t, size_t) override {}
+		/*
+		* @param const std::pmr::memory_resource& other: The resource to compare to.
+		* @return Whether the resource is this arena.
+		*/
+		inline bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+			return this == &other;
+		}
+
+	private:
+		// Allocation that did not fit in a buffer.
+		struct Overflow {
+			// The memory allocated from the heap.
+			void* data = 0;
+			// The alignment it was allocated with.
+			size_t align = 0;
+		};
+		// Memory for one frame's allocations.
+		struct Buffer {
+			// The memory of this buffer.
+			std::unique_ptr<unsigned char[]> data;
+			// The size in bytes of this buffer.
+			size_t size = 0;
+			// The number of bytes used.
+			std::atomic<size_t> used = 0;
+			// The allocations that did not fit, freed when this buffer is reused.
+			std::vector<Overflow> overflows;
+			// The number of bytes that did not fit.
+			size_t overflowBytes = 0;
+		};
+
+		// The buffers of this frame and the last.
+		Buffer buffers_[2];
+		// The index of this frame's buffer.
+		unsigned int current_ = 0;
+		// Mutex guarding the overflow allocations.
+		std::mutex mtx_;
+		// The number of allocations this frame.
+		std::atomic<unsigned int> allocations_ = 0;
+		// The number of bytes allocated this frame.
+		std::atomic<size_t> bytes_ = 0;
+		// The number of allocations that went to the heap this frame.
+		std::atomic<unsigned int> overflows_ = 0;
+		// The number of allocations in the last frame.
+		unsigned int frameAllocations_ = 0;
+		// The number of bytes allocated in the last frame.
+		size_t frameBytes_ = 0;
+		// The number of allocations that went to the heap in the last frame.
+		unsigned int frameOverflows_ = 0;
+
+		/*
+		* Free a buffer's overflow allocations, growing it to fit them, and mark it unused.
+		* @param Buffer& b: The buffer to reset.
+		*/
+		void reset(Buffer&);
+	};
+}
+
+#endif
\ No newline at end of file
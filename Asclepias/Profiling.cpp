@@ -0,0 +1,119 @@
+/*
+* File:		Profiling.cpp
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.07
+*/
+
+#include <chrono>
+#include <fstream>
+
+#include "Asclepias.h"
+
+namespace ASC {
+	// Define Profiler functions.
+
+	std::atomic<bool> Profiler::ENABLED = false;
+	std::vector<std::unique_ptr<Profiler::Buffer>> Profiler::BUFFERS;
+	std::mutex Profiler::MTX;
+	thread_local Profiler::Buffer* Profiler::LOCAL_BUFFER = 0;
+	long long Profiler::FRAMES[HISTORY] = {};
+	unsigned long long Profiler::FRAME_COUNT = 0;
+	std::string Profiler::DUMP_FILE = "";
+	unsigned int Profiler::DUMP_FRAMES = 0;
+
+	long long Profiler::Now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count() + 1;
+	}
+
+	void Profiler::Record(const char* name, long long start, long long end) {
+		Buffer& b = GetBuffer();
+		unsigned long long n = b.count.load(std::memory_order_relaxed);
+		Zone& z = b.zones[n % CAPACITY];
+		z.name = name;
+		z.start = start;
+		z.end = end;
+		b.count.store(n + 1, std::memory_order_release);
+	}
+
+	void Profiler::Frame() {
+		long long now = Now();
+		if (FRAME_COUNT > 0 && IsEnabled()) {
+			Record("Frame", FRAMES[(FRAME_COUNT - 1) % HISTORY], now);
+		}
+		if (!DUMP_FILE.empty()) {
+			unsigned long long frames = std::min<unsigned long long>(DUMP_FRAMES, FRAME_COUNT);
+			long long since = frames > 0 ? FRAMES[(FRAME_COUNT - frames) % HISTORY] : 0;
+			if (Write(DUMP_FILE, since)) {
+				ASCLOG(Profiler, Info, "Wrote ", frames, " frames of zones to ", DUMP_FILE, ".");
+			}
+			else {
+				ASCLOG(Profiler, Warning, "Failed to write zones to ", DUMP_FILE, ".");
+			}
+			DUMP_FILE = "";
+		}
+		FRAMES[FRAME_COUNT % HISTORY] = now;
+		FRAME_COUNT++;
+	}
+
+	void Profiler::SetThreadName(const std::string& name) {
+		Buffer& b = GetBuffer();
+		std::scoped_lock lock(MTX);
+		b.name = name;
+	}
+
+	void Profiler::Dump(const std::string& fileName, unsigned int frames) {
+		DUMP_FILE = fileName;
+		DUMP_FRAMES = frames < HISTORY ? frames : HISTORY - 1;
+	}
+
+	bool Profiler::Write(const std::string& fileName, long long since) {
+		std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		bool first = true;
+		std::scoped_lock lock(MTX);
+		for (std::unique_ptr<Buffer>& b : BUFFERS) {
+			file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+				<< b->tid << ",\"args\":{\"name\":\"" << b->name << "\"}}";
+			first = false;
+			unsigned long long count = b->count.load(std::memory_order_acquire);
+			unsigned long long oldest = count > CAPACITY ? count - CAPACITY : 0;
+			std::vector<Zone> zones;
+			for (unsigned long long i = oldest; i < count; i++) {
+				zones.push_back(b->zones[i % CAPACITY]);
+			}
+			// Skip zones the thread overwrote or was writing while they were copied.
+			unsigned long long now = b->count.load(std::memory_order_acquire) + 1;
+			unsigned long long valid = now > CAPACITY ? now - CAPACITY : 0;
+			size_t skip = valid > oldest ? (size_t)std::min(valid - oldest, count - oldest) : 0;
+			for (size_t i = skip; i < zones.size(); i++) {
+				const Zone& z = zones[i];
+				if (z.start < since) {
+					continue;
+				}
+				file << ",\n{\"name\":\"" << z.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << b->tid
+					<< ",\"ts\":" << z.start / 1000 << "." << z.start % 1000 / 100
+					<< ",\"dur\":" << (z.end - z.start) / 1000 << "." << (z.end - z.start) % 1000 / 100
+					<< "}";
+			}
+		}
+		file << "\n]}\n";
+		return file.good();
+	}
+
+	Profiler::Buffer& Profiler::GetBuffer() {
+		if (LOCAL_BUFFER == 0) {
+			std::unique_ptr<Buffer> b = std::make_unique<Buffer>();
+			b->zones.resize(CAPACITY);
+			std::scoped_lock lock(MTX);
+			b->tid = (unsigned int)BUFFERS.size() + 1;
+			b->name = "Thread " + std::to_string(b->tid);
+			LOCAL_BUFFER = b.get();
+			BUFFERS.push_back(std::move(b));
+		}
+		return *LOCAL_BUFFER;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+/*
+* File:		Profiling.h
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.07
+*/
+
+#ifndef ASC_PROFILING_H
+#define ASC_PROFILING_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+// Profiling zones are only compiled in when ASC_PROFILE is defined, as in Debug builds, and only
+// recorded once enabled with Profiler::SetEnabled().
+#ifdef ASC_PROFILE
+#define ASC_PROFILE_CONCAT_(A, B) A##B
+#define ASC_PROFILE_CONCAT(A, B) ASC_PROFILE_CONCAT_(A, B)
+#define ASC_PROFILE_SCOPE(NAME) \
+	ASC::ProfileScope ASC_PROFILE_CONCAT(ascProfileScope, __LINE__)(NAME)
+#define ASC_PROFILE_FRAME() ASC::Profiler::Frame()
+#define ASC_PROFILE_THREAD(NAME) ASC::Profiler::SetThreadName(NAME)
+#else
+#define ASC_PROFILE_SCOPE(NAME)
+#define ASC_PROFILE_FRAME()
+#define ASC_PROFILE_THREAD(NAME)
+#endif
+
+namespace ASC {
+	// Static utility recording timed zones per thread and writing them as Chrome trace JSON.
+	class Profiler {
+	public:
+		// Number of zones kept per thread before the oldest are overwritten.
+		static const unsigned int CAPACITY = 1 << 16;
+		// Number of frame start times kept for dumping.
+		static const unsigned int HISTORY = 600;
+
+		/*
+		* @return The current time in nanoseconds on a monotonic clock, never 0.
+		*/
+		static long long Now();
+		/*
+		* Record a finished zone in the calling thread's buffer.
+		* @param const char* name: The name of the zone, must outlive the profiler.
+		* @param long long start: The time the zone started from Now().
+		* @param long long end: The time the zone ended from Now().
+		*/
+		static void Record(const char*, long long, long long);
+		/*
+		* Mark the start of a frame on the main thread, writing a requested dump first.
+		*/
+		static void Frame();
+		/*
+		* @param const std::string& name: The name to show for the calling thread in traces.
+		*/
+		static void SetThreadName(const std::string&);
+		/*
+		* @param bool enabled: Whether zones are recorded.
+		*/
+		inline static void SetEnabled(bool enabled) {
+			ENABLED.store(enabled, std::memory_order_relaxed);
+		}
+		/*
+		* @return Whether zones are recorded.
+		*/
+		inline static bool IsEnabled() {
+			return ENABLED.load(std::memory_order_relaxed);
+		}
+		/*
+		* Request the zones of the last frames be written as Chrome trace JSON at the start of
+		* the next frame.
+		* @param const std::string& fileName: The file path to write the trace to.
+		* @param unsigned int frames: The number of frames to write, at most HISTORY.
+		*/
+		static void Dump(const std::string&, unsigned int = 120);
+		/*
+		* Write the zones since a time as Chrome trace JSON.
+		* @param const std::string& fileName: The file path to write the trace to.
+		* @param long long since: The earliest start time of zones to write from Now().
+		* @return Whether the file could be written.
+		*/
+		static bool Write(const std::string&, long long);
+
+	private:
+		// Timed zone recorded by a thread.
+		struct Zone {
+			// The name of the zone.
+			const char* name = 0;
+			// The time the zone started in nanoseconds.
+			long long start = 0;
+			// The time the zone ended in nanoseconds.
+			long long end = 0;
+		};
+		// Ring of zones written only by its thread.
+		struct Buffer {
+			// The recorded zones.
+			std::vector<Zone> zones;
+			// The number of zones ever recorded, published after each write.
+			std::atomic<unsigned long long> count = 0;
+			// The ID of the thread in traces.
+			unsigned int tid = 0;
+			// The name of the thread in traces.
+			std::string name = "";
+		};
+
+		// Whether zones are recorded, false until enabled.
+		static std::atomic<bool> ENABLED;
+		// The buffer of each thread that has recorded zones.
+		static std::vector<std::unique_ptr<Buffer>> BUFFERS;
+		// Mutex guarding registration of buffers and thread names.
+		static std::mutex MTX;
+		// The calling thread's buffer, 0 until it records a zone.
+		static thread_local Buffer* LOCAL_BUFFER;
+		// Ring of recent frame start times.
+		static long long FRAMES[HISTORY];
+		// The number of frames started.
+		static unsigned long long FRAME_COUNT;
+		// The file to write at the start of the next frame, empty for none.
+		static std::string DUMP_FILE;
+		// The number of frames to write at the start of the next frame.
+		static unsigned int DUMP_FRAMES;
+
+		/*
+		* @return The calling thread's buffer, registering a new one on first use.
+		*/
+		static Buffer& GetBuffer();
+	};
+
+	// Zone timed from its construction to the end of its scope.
+	class ProfileScope {
+	public:
+		/*
+		* Start timing a zone if the profiler is enabled.
+		* @param const char* name: The name of the zone, must outlive the profiler.
+		*/
+		inline ProfileScope(const char* name) : name_(name),
+			start_(Profiler::IsEnabled() ? Profiler::Now() : 0) {}
+		/*
+		* Record the zone if it was started.
+		*/
+		inline ~ProfileScope() {
+			if (start_ != 0) {
+				Profiler::Record(name_, start_, Profiler::Now());
+			}
+		}
+		/*
+		* Do not copy profile scopes.
+		*/
+		ProfileScope(const ProfileScope&) = delete;
+		/*
+		* Do not assign profile scopes.
+		*/
+		ProfileScope& operator = (const ProfileScope&) = delete;
+
+	private:
+		// The name of the zone.
+		const char* name_;
+		// The time the zone started, 0 if not recorded.
+		long long start_;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,190 @@
+/*
+* File:		Tasks.cpp
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.07
+*/
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include "Asclepias.h"
+
+namespace ASC {
+	// Define TaskPool functions.
+
+	TaskPool::Block* TaskPool::FREE[CLASSES] = {};
+	size_t TaskPool::MEMORY = 0;
+	std::mutex TaskPool::MTX;
+
+	void* TaskPool::Allocate(size_t size) {
+		unsigned int c = GetClass(size);
+		if (c == CLASSES) {
+			return ::operator new(size);
+		}
+		std::scoped_lock lock(MTX);
+		Block* b = FREE[c];
+		if (b == 0) {
+			MEMORY += MIN_BLOCK << c;
+			return ::operator new(MIN_BLOCK << c);
+		}
+		FREE[c] = b->next;
+		return b;
+	}
+
+	void TaskPool::Free(void* block, size_t size) {
+		unsigned int c = GetClass(size);
+		if (c == CLASSES) {
+			::operator delete(block);
+			return;
+		}
+		std::scoped_lock lock(MTX);
+		Block* b = (Block*)block;
+		b->next = FREE[c];
+		FREE[c] = b;
+	}
+
+	void TaskPool::Release() {
+		std::scoped_lock lock(MTX);
+		for (unsigned int c = 0; c < CLASSES; c++) {
+			while (FREE[c] != 0) {
+				Block* b = FREE[c];
+				FREE[c] = b->next;
+				::operator delete(b);
+				MEMORY -= MIN_BLOCK << c;
+			}
+		}
+	}
+
+	size_t TaskPool::GetMemory() {
+		std::scoped_lock lock(MTX);
+		return MEMORY;
+	}
+
+	unsigned int TaskPool::GetClass(size_t size) {
+		unsigned int c = 0;
+		while (c < CLASSES && (MIN_BLOCK << c) < size) {
+			c++;
+		}
+		return c;
+	}
+
+	// Define awaiter functions.
+
+	BackgroundAwaiter<std::string> ReadFile(const std::string& fileName) {
+		return Background([fileName]() {
+			std::ifstream file(fileName, std::ios::in | std::ios::binary);
+			if (!file.is_open()) {
+				return std::string();
+			}
+			std::stringstream data;
+			data << file.rdbuf();
+			return data.str();
+		});
+	}
+
+	// Define Task functions.
+
+	std::coroutine_handle<> Task::FinalAwaiter::await_suspend(
+		std::coroutine_handle<promise_type> h) noexcept {
+		promise_type& p = h.promise();
+		if (p.continuation) {
+			return p.continuation;
+		}
+		if (p.wait != 0) {
+			p.wait->done = true;
+		}
+		return std::noop_coroutine();
+	}
+
+	// Define TaskMgr functions.
+
+	void TaskMgr::init(JobMgr& jobs) {
+		jobs_ = &jobs;
+		frame_ = 0;
+		time_ = 0.0;
+	}
+
+	void TaskMgr::start(Task&& task, const void* owner) {
+		if (task.isDone()) {
+			return;
+		}
+		Entry& e = tasks_.emplace_back();
+		e.task = std::move(task);
+		e.owner = owner;
+		e.wait.mgr = this;
+		e.wait.handle = e.task.handle_;
+		e.wait.time = time_;
+		e.task.handle_.promise().wait = &e.wait;
+		e.task.handle_.resume();
+	}
+
+	void TaskMgr::update(double time) {
+		frame_++;
+		time_ = time;
+		std::list<Entry>::iterator it = tasks_.begin();
+		while (it != tasks_.end()) {
+			TaskWait& w = it->wait;
+			if (!it->cancelled && !w.done && frame_ >= w.frame && time_ >= w.time
+				&& (!w.ready || w.ready())) {
+				ASC_PROFILE_SCOPE("Task");
+				w.ready = std::function<bool()>();
+				w.handle.resume();
+			}
+			if (it->cancelled || w.done) {
+				it = tasks_.erase(it);
+			}
+			else {
+				it++;
+			}
+		}
+	}
+
+	double TaskMgr::getWakeTime() const {
+		double wake = HUGE_VAL;
+		for (const Entry& e : tasks_) {
+			const TaskWait& w = e.wait;
+			if (e.cancelled || w.done) {
+				continue;
+			}
+			if (w.frame > frame_ + 1 || w.ready) {
+				return time_;
+			}
+			wake = std::min(wake, w.time);
+		}
+		return wake;
+	}
+
+	void TaskMgr::cancel(const void* owner) {
+		for (Entry& e : tasks_) {
+			if (e.owner == owner) {
+				e.cancelled = true;
+			}
+		}
+	}
+
+	void TaskMgr::destroy() {
+		tasks_.clear();
+		TaskPool::Release();
+		jobs_ = 0;
+		frame_ = 0;
+		time_ = 0.0;
+	}
+
+	void TaskMgr::suspend(TaskWait& wait, std::coroutine_handle<> h, unsigned int frames,
+		double seconds, std::function<bool()> ready) {
+		wait.handle = h;
+		wait.frame = frame_ + frames;
+		wait.time = time_ + seconds;
+		wait.ready = std::move(ready);
+	}
+
+	void TaskMgr::submit(JobMgr::Job job) {
+		if (jobs_ == 0 || jobs_->getWorkers() == 0) {
+			// No worker would run the job until something waits on it.
+			job();
+			return;
+		}
+		jobs_->submit(std::move(job));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,458 @@
+/*
+* File:		Tasks.h
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.07
+*/
+
+#ifndef ASC_TASKS_H
+#define ASC_TASKS_H
+
+#include <coroutine>
+#include <future>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <type_traits>
+#include <exception>
+
+#include "Jobs.h"
+
+namespace ASC {
+	// Static pool of blocks coroutine frames are allocated from so tasks do not churn the heap.
+	class TaskPool {
+	public:
+		// Size in bytes of the smallest block.
+		static const size_t MIN_BLOCK = 64;
+		// Number of block sizes, each double the last, larger frames use the heap.
+		static const unsigned int CLASSES = 7;
+
+		/*
+		* @param size_t size: The size in bytes to allocate.
+		* @return A free block of at least the size.
+		*/
+		static void* Allocate(size_t);
+		/*
+		* Return a block to the pool for reuse.
+		* @param void* block: The block from Allocate().
+		* @param size_t size: The size it was allocated with.
+		*/
+		static void Free(void*, size_t);
+		/*
+		* Free every unused block back to the heap.
+		*/
+		static void Release();
+		/*
+		* @return The memory in bytes of every block the pool has allocated.
+		*/
+		static size_t GetMemory();
+
+	private:
+		// Unused block linked through its own memory.
+		struct Block {
+			// The next unused block of the same size.
+			Block* next;
+		};
+
+		// The unused blocks of each size.
+		static Block* FREE[CLASSES];
+		// The memory in bytes of every block allocated.
+		static size_t MEMORY;
+		// Mutex guarding the unused blocks.
+		static std::mutex MTX;
+
+		/*
+		* @param size_t size: The size in bytes to allocate.
+		* @return The index of the smallest block size that fits or CLASSES if none does.
+		*/
+		static unsigned int GetClass(size_t);
+	};
+
+	class TaskMgr;
+
+	// Condition a started task resumes on, shared by every task it awaits.
+	struct TaskWait {
+		// The task manager running the task.
+		TaskMgr* mgr = 0;
+		// The innermost suspended coroutine of the task.
+		std::coroutine_handle<> handle;
+		// The frame the task resumes on or after.
+		unsigned long long frame = 0;
+		// The time in seconds the task resumes at or after.
+		double time = 0.0;
+		// Checked once the frame and time pass, the task resumes once it returns true.
+		std::function<bool()> ready;
+		// Whether the task has returned.
+		bool done = false;
+	};
+
+	// Awaiter resuming a task after a number of frames.
+	class FramesAwaiter {
+	public:
+		/*
+		* @param unsigned int frames: The number of frames to wait.
+		*/
+		inline FramesAwaiter(unsigned int frames) : frames_(frames) {}
+		inline bool await_ready() const {
+			return frames_ == 0;
+		}
+		template <typename P>
+		void await_suspend(std::coroutine_handle<P> h) {
+			h.promise().wait->mgr->suspend(*h.promise().wait, h, frames_, 0.0);
+		}
+		inline void await_resume() const {}
+
+	private:
+		// The number of frames to wait.
+		unsigned int frames_;
+	};
+
+	// Awaiter resuming a task once an amount of time has passed.
+	class DelayAwaiter {
+	public:
+		/*
+		* @param double seconds: The time in seconds to wait.
+		*/
+		inline DelayAwaiter(double seconds) : seconds_(seconds) {}
+		inline bool await_ready() const {
+			return seconds_ <= 0.0;
+		}
+		template <typename P>
+		void await_suspend(std::coroutine_handle<P> h) {
+			h.promise().wait->mgr->suspend(*h.promise().wait, h, 1, seconds_);
+		}
+		inline void await_resume() const {}
+
+	private:
+		// The time in seconds to wait.
+		double seconds_;
+	};
+
+	// Awaiter running work on the job system and resuming a task with its result.
+	template <typename T>
+	class BackgroundAwaiter {
+	public:
+		/*
+		* @param std::function<T()> work: The work to run, must not touch the window or OpenGL.
+		*/
+		BackgroundAwaiter(std::function<T()> work) : work_(std::move(work)),
+			state_(std::make_shared<State>()) {}
+		inline bool await_ready() const {
+			return false;
+		}
+		template <typename P>
+		void await_suspend(std::coroutine_handle<P> h) {
+			// The job owns the state so a task cancelled before it finishes is not written to.
+			std::shared_ptr<State> state = state_;
+			h.promise().wait->mgr->submit([state, work = std::move(work_)]() {
+				if constexpr (std::is_void_v<T>) {
+					work();
+				}
+				else {
+					state->value = work();
+				}
+				state->done.store(true, std::memory_order_release);
+			});
+			h.promise().wait->mgr->suspend(*h.promise().wait, h, 1, 0.0, [state]() {
+				return state->done.load(std::memory_order_acquire);
+			});
+		}
+		T await_resume() {
+			if constexpr (!std::is_void_v<T>) {
+				return std::move(state_->value);
+			}
+		}
+
+	private:
+		// Result shared between the task and the job.
+		struct State {
+			// Set once the work has finished.
+			std::atomic<bool> done = false;
+			// The result of the work.
+			std::conditional_t<std::is_void_v<T>, char, T> value{};
+		};
+
+		// The work to run.
+		std::function<T()> work_;
+		// The result of the work.
+		std::shared_ptr<State> state_;
+	};
+
+	// Awaiter resuming a task with the value of a future once it is ready.
+	template <typename T>
+	class FutureAwaiter {
+	public:
+		/*
+		* @param std::future<T>& future: The future to wait on, outlives the awaiter.
+		*/
+		FutureAwaiter(std::future<T>& future) : future_(future) {}
+		bool await_ready() const {
+			return future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		}
+		template <typename P>
+		void await_suspend(std::coroutine_handle<P> h) {
+			std::future<T>& future = future_;
+			h.promise().wait->mgr->suspend(*h.promise().wait, h, 1, 0.0, [&future]() {
+				return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+			});
+		}
+		T await_resume() {
+			return future_.get();
+		}
+
+	private:
+		// The future to wait on.
+		std::future<T>& future_;
+	};
+
+	/*
+	* @param unsigned int frames: The number of frames to wait, 0 to not suspend.
+	* @return An awaiter resuming a task after the frames.
+	*/
+	inline FramesAwaiter NextFrame(unsigned int frames = 1) {
+		return FramesAwaiter(frames);
+	}
+	/*
+	* @param double seconds: The time in seconds to wait, counted in fixed updates so replays
+	* resume the task on the same update.
+	* @return An awaiter resuming a task on the first frame after the time has passed.
+	*/
+	inline DelayAwaiter Delay(double seconds) {
+		return DelayAwaiter(seconds);
+	}
+	/*
+	* Run work on the job system, such as Renderer::preloadTexture(), while a task waits.
+	* @param F work: The function to run, must not touch the window or OpenGL.
+	* @return An awaiter resuming a task with the work's result on the frame after it finishes.
+	*/
+	template <typename F>
+	BackgroundAwaiter<std::invoke_result_t<F>> Background(F work) {
+		return BackgroundAwaiter<std::invoke_result_t<F>>(std::move(work));
+	}
+	/*
+	* Read a whole file on the job system while a task waits.
+	* @param const std::string& fileName: The path to the file.
+	* @return An awaiter resuming a task with the file's contents, empty if it could not be read.
+	*/
+	BackgroundAwaiter<std::string> ReadFile(const std::string&);
+
+	// Coroutine run by a task manager once per frame, which may await other tasks,
+	// NextFrame(), Delay(), Background(), ReadFile() and std::future.
+	class Task {
+	public:
+		struct promise_type;
+		// Awaiter resuming the awaiting task when a task returns.
+		struct FinalAwaiter {
+			inline bool await_ready() const noexcept {
+				return false;
+			}
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type>) noexcept;
+			inline void await_resume() const noexcept {}
+		};
+		// Coroutine state of a task.
+		struct promise_type {
+			// The wait condition of the started task this one runs in, 0 until started.
+			TaskWait* wait = 0;
+			// The task awaiting this one, resumed when it returns.
+			std::coroutine_handle<> continuation;
+
+			inline Task get_return_object() {
+				return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+			inline std::suspend_always initial_suspend() noexcept {
+				return {};
+			}
+			inline FinalAwaiter final_suspend() noexcept {
+				return {};
+			}
+			inline void return_void() {}
+			inline void unhandled_exception() {
+				std::terminate();
+			}
+			template <typename T>
+			FutureAwaiter<T> await_transform(std::future<T>& future) {
+				return FutureAwaiter<T>(future);
+			}
+			template <typename T>
+			FutureAwaiter<T> await_transform(std::future<T>&& future) {
+				return FutureAwaiter<T>(future);
+			}
+			template <typename A>
+			A&& await_transform(A&& awaiter) {
+				return std::forward<A>(awaiter);
+			}
+			inline static void* operator new(size_t size) {
+				return TaskPool::Allocate(size);
+			}
+			inline static void operator delete(void* p, size_t size) {
+				TaskPool::Free(p, size);
+			}
+		};
+		// Awaiter running a task inside the awaiting one.
+		struct Awaiter {
+			// The task to run.
+			std::coroutine_handle<promise_type> handle;
+
+			inline bool await_ready() const {
+				return !handle || handle.done();
+			}
+			template <typename P>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) {
+				handle.promise().wait = h.promise().wait;
+				handle.promise().continuation = h;
+				return handle;
+			}
+			inline void await_resume() const {}
+		};
+
+		/*
+		* Construct an empty task.
+		*/
+		Task() = default;
+		/*
+		* Take ownership of a task's coroutine.
+		* @param Task&& t: The task to move.
+		*/
+		inline Task(Task&& t) noexcept : handle_(t.handle_) {
+			t.handle_ = 0;
+		}
+		/*
+		* Take ownership of a task's coroutine, destroying this task's.
+		* @param Task&& t: The task to move.
+		* @return This task.
+		*/
+		inline Task& operator = (Task&& t) noexcept {
+			if (this != &t) {
+				if (handle_) {
+					handle_.destroy();
+				}
+				handle_ = t.handle_;
+				t.handle_ = 0;
+			}
+			return *this;
+		}
+		/*
+		* Do not copy tasks, they own their coroutine.
+		*/
+		Task(const Task&) = delete;
+		/*
+		* Destroy this task's coroutine wherever it is suspended.
+		*/
+		inline ~Task() {
+			if (handle_) {
+				handle_.destroy();
+			}
+		}
+		/*
+		* @return Whether this task has returned.
+		*/
+		inline bool isDone() const {
+			return !handle_ || handle_.done();
+		}
+		/*
+		* Run this task inside the awaiting one, resuming it when this returns.
+		*/
+		inline Awaiter operator co_await() && {
+			return Awaiter{ handle_ };
+		}
+
+	private:
+		friend class TaskMgr;
+
+		// The coroutine of this task.
+		std::coroutine_handle<promise_type> handle_;
+
+		/*
+		* @param std::coroutine_handle<promise_type> handle: The coroutine to own.
+		*/
+		inline explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+	};
+
+	// App utility resuming started tasks on the main thread once their wait condition is met.
+	class TaskMgr {
+	public:
+		/*
+		* Initialize this task manager's memory.
+		* @param JobMgr& jobs: The job system to run background work on.
+		*/
+		void init(JobMgr&);
+		/*
+		* Start a task, running it until it first suspends. Call on the main thread.
+		* @param Task&& task: The task to start.
+		* @param const void* owner: The owner to cancel the task with, 0 for none.
+		*/
+		void start(Task&&, const void* = 0);
+		/*
+		* Advance a frame and resume the tasks that are ready.
+		* @param double time: The current time in seconds on the App's task clock.
+		*/
+		void update(double);
+		/*
+		* Stop the tasks of an owner from resuming, they are destroyed on the next update().
+		* @param const void* owner: The owner the tasks were started with.
+		*/
+		void cancel(const void*);
+		/*
+		* Destroy every task and free this task manager's memory.
+		*/
+		void destroy();
+		/*
+		* Suspend a task until a wait condition is met, called by awaiters.
+		* @param TaskWait& wait: The task's wait condition.
+		* @param std::coroutine_handle<> h: The coroutine to resume.
+		* @param unsigned int frames: The number of frames to wait.
+		* @param double seconds: The time in seconds to wait.
+		* @param std::function<bool()> ready: Checked once the frames and time pass, empty for none.
+		*/
+		void suspend(TaskWait&, std::coroutine_handle<>, unsigned int, double,
+			std::function<bool()> = std::function<bool()>());
+		/*
+		* Run background work for an awaiter, on the calling thread if there are no workers.
+		* @param JobMgr::Job job: The work to run.
+		*/
+		void submit(JobMgr::Job);
+		/*
+		* @return The number of tasks started and not yet returned.
+		*/
+		inline unsigned int getCount() const {
+			return (unsigned int)tasks_.size();
+		}
+		/*
+		* @return The earliest time a task may resume at if the next update() is at or after it,
+		* the current time if a task waits on more frames or background work, HUGE_VAL if none.
+		*/
+		double getWakeTime() const;
+		/*
+		* @return The number of frames this task manager has advanced.
+		*/
+		inline unsigned long long getFrame() const {
+			return frame_;
+		}
+
+	private:
+		// Task started on this task manager.
+		struct Entry {
+			// The task.
+			Task task;
+			// The task's wait condition.
+			TaskWait wait;
+			// The owner to cancel the task with.
+			const void* owner = 0;
+			// Whether the task was cancelled.
+			bool cancelled = false;
+		};
+
+		// The job system background work is run on.
+		JobMgr* jobs_ = 0;
+		// The started tasks, stable so their wait conditions can be pointed to.
+		std::list<Entry> tasks_;
+		// The number of frames advanced.
+		unsigned long long frame_ = 0;
+		// The time in seconds of the current frame.
+		double time_ = 0.0;
+	};
+}
+
+#endif
\ No newline at end of file
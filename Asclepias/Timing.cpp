@@ -0,0 +1,410 @@
+/*
+* File:		Timing.cpp
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.07
+*/
+
+#include <thread>
+#include <cmath>
+#include <numeric>
+
+#include "Asclepias.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <timeapi.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+namespace ASC {
+	// Define FramePacer functions.
+
+	void FramePacer::init(double targetFPS, bool vsync, int refreshRate) {
+		targetFPS_ = targetFPS;
+		vsync_ = vsync;
+		refreshRate_ = refreshRate > 0 ? refreshRate : 60;
+		history_.assign(HISTORY, 0.0);
+		cursor_ = 0;
+		updatePeriod();
+		last_ = Clock::now();
+		next_ = last_;
+		granularity_ = 0.0;
+#ifdef _WIN32
+		timer_ = CreateWaitableTimerExW(0, 0, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+			TIMER_ALL_ACCESS);
+		if (timer_ != 0) {
+			ASCLOG(Pacer, Info, "Pacing frames with a high resolution waitable timer.");
+		}
+		else {
+			timerPeriod_ = timeBeginPeriod(1) == TIMERR_NOERROR;
+			ASCLOG(Pacer, Info, "Pacing frames with ", timerPeriod_ ? "1 ms" : "default",
+				" timer resolution.");
+		}
+#endif
+	}
+
+	void FramePacer::destroy() {
+#ifdef _WIN32
+		if (timer_ != 0) {
+			CloseHandle((HANDLE)timer_);
+		}
+		if (timerPeriod_) {
+			timeEndPeriod(1);
+		}
+#endif
+		timer_ = 0;
+		timerPeriod_ = false;
+	}
+
+	void FramePacer::wait() {
+		Clock::time_point now = Clock::now();
+		if (period_ > 0.0 && !swapPaced_) {
+			std::chrono::duration<double> period(period_);
+			next_ += std::chrono::duration_cast<Clock::duration>(period);
+			if (next_ < now - std::chrono::duration_cast<Clock::duration>(period)) {
+				next_ = now;
+			}
+			while (true) {
+				double remaining = std::chrono::duration<double>(next_ - now).count();
+				if (remaining <= margin_) {
+					break;
+				}
+				double nap = remaining - margin_;
+				sleep(nap);
+				Clock::time_point woke = Clock::now();
+				double overshoot = std::chrono::duration<double>(woke - now).count() - nap;
+				granularity_ += (overshoot - granularity_) * 0.1;
+				if (overshoot > margin_) {
+					margin_ = std::min(overshoot * 1.25, period_);
+				}
+				else if (overshoot < margin_ / 2.0) {
+					margin_ = std::max({ margin_ * 0.99, granularity_, 0.0005 });
+				}
+				now = woke;
+			}
+			while (now < next_) {
+				std::this_thread::yield();
+				now = Clock::now();
+			}
+		}
+		else {
+			next_ = now;
+		}
+		history_[cursor_] = std::chrono::duration<double>(now - last_).count();
+		cursor_ = (cursor_ + 1) % HISTORY;
+		last_ = now;
+	}
+
+	void FramePacer::setTargetFPS(double targetFPS) {
+		targetFPS_ = targetFPS;
+		updatePeriod();
+	}
+
+	void FramePacer::setVsync(bool vsync) {
+		vsync_ = vsync;
+		updatePeriod();
+	}
+
+	double FramePacer::getFrameTime() const {
+		double sum = 0.0;
+		unsigned int n = 0;
+		for (double t : history_) {
+			if (t > 0.0) {
+				sum += t;
+				n++;
+			}
+		}
+		return n > 0 ? sum / n : 0.0;
+	}
+
+	double FramePacer::getJitter() const {
+		double mean = getFrameTime();
+		double sum = 0.0;
+		unsigned int n = 0;
+		for (double t : history_) {
+			if (t > 0.0) {
+				sum += (t - mean) * (t - mean);
+				n++;
+			}
+		}
+		return n > 1 ? std::sqrt(sum / (n - 1)) : 0.0;
+	}
+
+	double FramePacer::getMaxDeviation() const {
+		double target = period_ > 0.0 ? period_ : getFrameTime();
+		double dev = 0.0;
+		for (double t : history_) {
+			if (t > 0.0) {
+				dev = std::max(dev, std::abs(t - target));
+			}
+		}
+		return dev;
+	}
+
+	void FramePacer::sleep(double seconds) {
+#ifdef _WIN32
+		if (timer_ != 0) {
+			LARGE_INTEGER due;
+			due.QuadPart = -(LONGLONG)(seconds * 10000000.0);
+			if (SetWaitableTimerEx((HANDLE)timer_, &due, 0, 0, 0, 0, 0)) {
+				WaitForSingleObject((HANDLE)timer_, INFINITE);
+				return;
+			}
+		}
+#endif
+		std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+	}
+
+	void FramePacer::updatePeriod() {
+		if (targetFPS_ < 0.0) {
+			period_ = 0.0;
+		}
+		else if (targetFPS_ == 0.0) {
+			period_ = 1.0 / refreshRate_;
+		}
+		else {
+			period_ = 1.0 / targetFPS_;
+		}
+		swapPaced_ = vsync_ && period_ > 0.0 && period_ <= 1.01 / refreshRate_;
+	}
+
+	// Define FrameGovernor functions.
+
+	void FrameGovernor::init(double budget, unsigned int downFrames, unsigned int upFrames,
+		double upHeadroom) {
+		budget_ = budget;
+		downFrames_ = downFrames > 0 ? downFrames : 1;
+		upFrames_ = upFrames;
+		upHeadroom_ = upHeadroom;
+		sum_ = 0.0;
+		frames_ = 0;
+		dropped_ = 0;
+		headroom_ = 0;
+	}
+
+	void FrameGovernor::frame(double frameTime, bool dropped) {
+		if (!enabled_ || budget_ <= 0.0 || knobs_.empty()) {
+			return;
+		}
+		sum_ += frameTime;
+		frames_++;
+		dropped_ += dropped ? 1 : 0;
+		if (frames_ < downFrames_) {
+			return;
+		}
+		double avg = sum_ / frames_;
+		if (avg > budget_) {
+			headroom_ = 0;
+			if (step(true, avg) && dropped_ > 0) {
+				ASCLOG(Governor, Info, dropped_, " of the last ", frames_, " frames dropped updates.");
+			}
+		}
+		else if (avg < budget_ * upHeadroom_) {
+			headroom_ += frames_;
+			if (headroom_ >= upFrames_) {
+				headroom_ = 0;
+				step(false, avg);
+			}
+		}
+		else {
+			// Between the thresholds, so hold the current levels.
+			headroom_ = 0;
+		}
+		sum_ = 0.0;
+		frames_ = 0;
+		dropped_ = 0;
+	}
+
+	unsigned int FrameGovernor::addKnob(const std::string& name, unsigned int levels,
+		const Knob& apply) {
+		KnobState k;
+		k.id = nextID_++;
+		k.name = name;
+		k.levels = levels > 0 ? levels : 1;
+		k.apply = apply;
+		knobs_.push_back(k);
+		ASCLOG(Governor, Info, "Added quality knob ", name, " with ", k.levels, " levels.");
+		return k.id;
+	}
+
+	bool FrameGovernor::removeKnob(unsigned int id) {
+		for (std::vector<KnobState>::iterator it = knobs_.begin(); it != knobs_.end(); it++) {
+			if (it->id == id) {
+				ASCLOG(Governor, Info, "Removed quality knob ", it->name, ".");
+				knobs_.erase(it);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	unsigned int FrameGovernor::getLevel(unsigned int id) const {
+		for (const KnobState& k : knobs_) {
+			if (k.id == id) {
+				return k.level;
+			}
+		}
+		return 0;
+	}
+
+	void FrameGovernor::destroy() {
+		knobs_.clear();
+		nextID_ = 0;
+		sum_ = 0.0;
+		frames_ = 0;
+		dropped_ = 0;
+		headroom_ = 0;
+	}
+
+	void FrameGovernor::setBudget(double budget) {
+		budget_ = budget;
+		sum_ = 0.0;
+		frames_ = 0;
+		dropped_ = 0;
+		headroom_ = 0;
+	}
+
+	bool FrameGovernor::step(bool down, double avg) {
+		KnobState* best = 0;
+		for (KnobState& k : knobs_) {
+			if (down && k.level + 1 < k.levels && (best == 0 || k.level < best->level)) {
+				best = &k;
+			}
+			else if (!down && k.level > 0 && (best == 0 || k.level >= best->level)) {
+				best = &k;
+			}
+		}
+		if (best == 0) {
+			return false;
+		}
+		best->level = down ? best->level + 1 : best->level - 1;
+		ASCLOG(Governor, Info, "Stepped ", best->name, down ? " down" : " up", " to level ",
+			best->level, " of ", best->levels - 1, ", frames averaged ", avg * 1000.0, " ms for a ",
+			budget_ * 1000.0, " ms budget.");
+		best->apply(best->level);
+		return true;
+	}
+
+	// Define TickScheduler functions.
+
+	void TickScheduler::init(double targetUPS) {
+		targetUPS_ = targetUPS > 0.0 ? targetUPS : 60.0;
+		ticks_ = 0;
+		tickTime_ = 0.0;
+	}
+
+	void TickScheduler::tick() {
+		ticking_ = true;
+		tickTime_ = 0.0;
+		for (SystemState& s : systems_) {
+			if (s.removed || ticks_ % s.stats.interval != s.stats.phase) {
+				continue;
+			}
+			FramePacer::Clock::time_point start = FramePacer::Clock::now();
+			s.update((float)s.stats.interval);
+			double time = std::chrono::duration<double>(FramePacer::Clock::now() - start).count();
+			Stats& st = s.stats;
+			st.calls++;
+			st.last = time;
+			st.average += (time - st.average) / st.calls;
+			st.max = std::max(st.max, time);
+			tickTime_ += time;
+		}
+		ticking_ = false;
+		systems_.remove_if([](const SystemState& s) {
+			return s.removed;
+		});
+		ticks_++;
+	}
+
+	unsigned int TickScheduler::add(const std::string& name, double rate, const System& update,
+		int phase, const void* owner) {
+		SystemState s;
+		s.id = nextID_++;
+		s.owner = owner;
+		s.update = update;
+		s.stats.name = name;
+		s.stats.interval = rate > 0.0 ? (unsigned int)std::max(1.0, std::round(targetUPS_ / rate)) : 1;
+		s.stats.rate = targetUPS_ / s.stats.interval;
+		if (phase >= 0) {
+			// Phases count from the next fixed update.
+			s.stats.phase = (unsigned int)((ticks_ + phase) % s.stats.interval);
+		}
+		else {
+			// Two systems share ticks exactly when their phases match modulo the GCD of their
+			// intervals, so pick the phase sharing the fewest and cheapest.
+			double best = -1.0;
+			for (unsigned int p = 0; p < s.stats.interval; p++) {
+				double cost = 0.0;
+				for (const SystemState& o : systems_) {
+					unsigned int g = std::gcd(s.stats.interval, o.stats.interval);
+					if (!o.removed && p % g == o.stats.phase % g) {
+						cost += 1.0 + o.stats.average * 1000.0;
+					}
+				}
+				if (best < 0.0 || cost < best) {
+					best = cost;
+					s.stats.phase = p;
+				}
+			}
+		}
+		systems_.push_back(s);
+		ASCLOG(Scheduler, Info, "Added system ", name, " at ", s.stats.rate, " Hz, phase ",
+			s.stats.phase, " of ", s.stats.interval, ".");
+		return s.id;
+	}
+
+	bool TickScheduler::remove(unsigned int id) {
+		for (std::list<SystemState>::iterator it = systems_.begin(); it != systems_.end(); it++) {
+			if (it->id == id && !it->removed) {
+				ASCLOG(Scheduler, Info, "Removed system ", it->stats.name, " after ", it->stats.calls,
+					" calls averaging ", it->stats.average * 1000.0, " ms with a max of ",
+					it->stats.max * 1000.0, " ms.");
+				if (ticking_) {
+					it->removed = true;
+				}
+				else {
+					systems_.erase(it);
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void TickScheduler::removeAll(const void* owner) {
+		std::vector<unsigned int> ids;
+		for (const SystemState& s : systems_) {
+			if (s.owner == owner && !s.removed) {
+				ids.push_back(s.id);
+			}
+		}
+		for (unsigned int id : ids) {
+			remove(id);
+		}
+	}
+
+	std::vector<TickScheduler::Stats> TickScheduler::getStats() const {
+		std::vector<Stats> stats;
+		for (const SystemState& s : systems_) {
+			if (!s.removed) {
+				stats.push_back(s.stats);
+			}
+		}
+		return stats;
+	}
+
+	void TickScheduler::destroy() {
+		for (const SystemState& s : systems_) {
+			ASCLOG(Scheduler, Info, "System ", s.stats.name, " ran ", s.stats.calls, " times at ",
+				s.stats.rate, " Hz, averaging ", s.stats.average * 1000.0, " ms with a max of ",
+				s.stats.max * 1000.0, " ms.");
+		}
+		systems_.clear();
+		nextID_ = 0;
+		ticks_ = 0;
+		tickTime_ = 0.0;
+	}
+}
\ No newline at end of file
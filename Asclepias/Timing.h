@@ -0,0 +1,334 @@
+/*
+* File:		Timing.h
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.07
+*/
+
+#ifndef ASC_TIMING_H
+#define ASC_TIMING_H
+
+#include <chrono>
+#include <vector>
+#include <string>
+#include <functional>
+#include <list>
+
+namespace ASC {
+	// Utility for pacing frames to a target rate with a monotonic clock.
+	class FramePacer {
+	public:
+		// The clock frames are timed with.
+		typedef std::chrono::steady_clock Clock;
+		// Number of recent frame times kept for jitter statistics.
+		static const unsigned int HISTORY = 240;
+
+		/*
+		* Initialize this pacer's memory and raise the system timer's resolution, using a high
+		* resolution waitable timer on Windows where available.
+		* @param double targetFPS: The frame rate to pace to, 0 for the monitor's refresh rate and
+		* negative for uncapped.
+		* @param bool vsync: Whether buffer swaps wait for vertical sync.
+		* @param int refreshRate: The monitor's refresh rate in hertz.
+		*/
+		void init(double, bool, int);
+		/*
+		* Free this pacer's timer and restore the system timer's resolution.
+		*/
+		void destroy();
+		/*
+		* Wait until the next frame's deadline, sleeping while far from it and spinning close to it.
+		*/
+		void wait();
+		/*
+		* @param double targetFPS: The frame rate to pace to, 0 for the monitor's refresh rate and
+		* negative for uncapped.
+		*/
+		void setTargetFPS(double);
+		/*
+		* @return The frame rate being paced to, 0 if uncapped.
+		*/
+		inline double getTargetFPS() const {
+			return period_ > 0.0 ? 1.0 / period_ : 0.0;
+		}
+		/*
+		* @param bool vsync: Whether buffer swaps wait for vertical sync.
+		*/
+		void setVsync(bool);
+		/*
+		* @return The mean time between recent frames in seconds.
+		*/
+		double getFrameTime() const;
+		/*
+		* @return The standard deviation of recent frame times in seconds.
+		*/
+		double getJitter() const;
+		/*
+		* @return The largest difference of a recent frame time from the target period in seconds.
+		*/
+		double getMaxDeviation() const;
+		/*
+		* @return The time in seconds the pacer's sleeps have overshot by, spun away instead.
+		*/
+		inline double getSpinMargin() const {
+			return margin_;
+		}
+
+	private:
+		// The requested frame rate, 0 for the refresh rate and negative for uncapped.
+		double targetFPS_ = 0.0;
+		// The time in seconds between frame deadlines, 0 if uncapped.
+		double period_ = 0.0;
+		// Whether buffer swaps wait for vertical sync.
+		bool vsync_ = false;
+		// The monitor's refresh rate in hertz.
+		int refreshRate_ = 60;
+		// Whether swaps already pace frames so waiting is skipped.
+		bool swapPaced_ = false;
+		// The deadline of the next frame.
+		Clock::time_point next_;
+		// The end of the previous wait.
+		Clock::time_point last_;
+		// The time in seconds left to spin after sleeping, grown when sleeps overshoot.
+		double margin_ = 0.002;
+		// The mean time in seconds recent sleeps overshot by, the least margin kept.
+		double granularity_ = 0.0;
+		// The high resolution waitable timer slept on, 0 if unavailable.
+		void* timer_ = 0;
+		// Whether the system timer's resolution was raised and must be restored.
+		bool timerPeriod_ = false;
+		// Ring of recent frame times in seconds.
+		std::vector<double> history_;
+		// The next index to write in the frame time ring.
+		unsigned int cursor_ = 0;
+
+		/*
+		* Recompute the frame period from the target, refresh rate and vsync.
+		*/
+		void updatePeriod();
+		/*
+		* Sleep the calling thread on the pacer's timer.
+		* @param double seconds: The time to sleep for in seconds.
+		*/
+		void sleep(double);
+	};
+
+	// Utility stepping registered quality knobs down under sustained frame overruns and back up
+	// once there is headroom again.
+	class FrameGovernor {
+	public:
+		// Callback applying a quality level to a knob, 0 for full quality.
+		typedef std::function<void(unsigned int)> Knob;
+
+		/*
+		* Initialize this governor's memory.
+		* @param double budget: The frame time budget in seconds, 0 to never step.
+		* @param unsigned int downFrames: The number of frames averaged per decision.
+		* @param unsigned int upFrames: The number of frames with headroom before stepping up.
+		* @param double upHeadroom: The fraction of the budget frames must average under to count
+		* as having headroom.
+		*/
+		void init(double, unsigned int, unsigned int, double);
+		/*
+		* Record the work time of a frame and step a knob if a decision is due.
+		* @param double frameTime: The time in seconds the frame took, excluding pacing waits.
+		* @param bool dropped: Whether the frame dropped fixed updates past the limit.
+		*/
+		void frame(double, bool);
+		/*
+		* Register a quality knob, stepped down before knobs registered later at the same level.
+		* @param const std::string& name: The name of the knob in logs.
+		* @param unsigned int levels: The number of quality levels including full quality.
+		* @param const Knob& apply: Called with the knob's new level each time it is stepped.
+		* @return The ID of the knob.
+		*/
+		unsigned int addKnob(const std::string&, unsigned int, const Knob&);
+		/*
+		* Unregister a quality knob without calling it.
+		* @param unsigned int id: The ID of the knob.
+		* @return Whether the knob was registered.
+		*/
+		bool removeKnob(unsigned int);
+		/*
+		* @param unsigned int id: The ID of the knob.
+		* @return The knob's current level, 0 for full quality or an unregistered knob.
+		*/
+		unsigned int getLevel(unsigned int) const;
+		/*
+		* Free this governor's memory.
+		*/
+		void destroy();
+		/*
+		* @return Whether this governor steps knobs.
+		*/
+		inline bool isEnabled() const {
+			return enabled_;
+		}
+		/*
+		* @param bool enabled: Whether this governor steps knobs.
+		*/
+		inline void setEnabled(bool enabled) {
+			enabled_ = enabled;
+		}
+		/*
+		* @return The frame time budget in seconds.
+		*/
+		inline double getBudget() const {
+			return budget_;
+		}
+		/*
+		* @param double budget: The frame time budget in seconds, 0 to never step.
+		*/
+		void setBudget(double);
+
+	private:
+		// Quality knob registered with the governor.
+		struct KnobState {
+			// The ID of the knob.
+			unsigned int id = 0;
+			// The name of the knob in logs.
+			std::string name = "";
+			// The number of quality levels.
+			unsigned int levels = 1;
+			// The current level, 0 for full quality.
+			unsigned int level = 0;
+			// Callback applying a level.
+			Knob apply;
+		};
+
+		// Whether this governor steps knobs.
+		bool enabled_ = false;
+		// The frame time budget in seconds.
+		double budget_ = 0.0;
+		// The number of frames averaged per decision.
+		unsigned int downFrames_ = 30;
+		// The number of frames with headroom before stepping up.
+		unsigned int upFrames_ = 180;
+		// The fraction of the budget frames must average under to have headroom.
+		double upHeadroom_ = 0.75;
+		// The registered knobs in registration order.
+		std::vector<KnobState> knobs_;
+		// The ID of the next registered knob.
+		unsigned int nextID_ = 0;
+		// The total work time of the frames since the last decision.
+		double sum_ = 0.0;
+		// The number of frames since the last decision.
+		unsigned int frames_ = 0;
+		// The number of frames since the last decision that dropped updates.
+		unsigned int dropped_ = 0;
+		// The number of consecutive frames with headroom.
+		unsigned int headroom_ = 0;
+
+		/*
+		* Step the knob furthest from its limit one level.
+		* @param bool down: Whether to step quality down rather than up.
+		* @param double avg: The average frame time that caused the step, for the log.
+		* @return Whether a knob could be stepped.
+		*/
+		bool step(bool, double);
+	};
+
+	// Utility running registered update callbacks at their own fraction of the fixed update rate,
+	// with phases spreading low rate work across ticks.
+	class TickScheduler {
+	public:
+		// Callback updating a system, passed the timestep in fixed updates since its last call.
+		typedef std::function<void(float)> System;
+		// Timing statistics of a registered system.
+		struct Stats {
+			// The name of the system.
+			std::string name = "";
+			// The rate in hertz the system runs at.
+			double rate = 0.0;
+			// The number of fixed updates between calls.
+			unsigned int interval = 1;
+			// The fixed update within each interval the system runs on, counted from the first.
+			unsigned int phase = 0;
+			// The number of calls.
+			unsigned long long calls = 0;
+			// The time in seconds of the last call.
+			double last = 0.0;
+			// The average time in seconds per call.
+			double average = 0.0;
+			// The longest time in seconds of a call.
+			double max = 0.0;
+		};
+
+		/*
+		* Initialize this scheduler's memory.
+		* @param double targetUPS: The number of fixed updates per second.
+		*/
+		void init(double);
+		/*
+		* Run the systems due on the next fixed update.
+		*/
+		void tick();
+		/*
+		* Register a system, called from the thread updating scenes or while it is not.
+		* @param const std::string& name: The name of the system in stats and logs.
+		* @param double rate: The rate in hertz to run at, rounded to a whole number of fixed
+		* updates, 0 for every fixed update.
+		* @param const System& update: Called with the system's timestep each time it is due.
+		* @param int phase: The fixed update within each interval to run on counting from the
+		* next, negative to pick the one colliding least with other systems weighted by their
+		* measured time.
+		* @param const void* owner: The owner to remove the system with, 0 for none.
+		* @return The ID of the system.
+		*/
+		unsigned int add(const std::string&, double, const System&, int = -1, const void* = 0);
+		/*
+		* Unregister a system, safe to call from a system.
+		* @param unsigned int id: The ID of the system.
+		* @return Whether the system was registered.
+		*/
+		bool remove(unsigned int);
+		/*
+		* Unregister every system of an owner.
+		* @param const void* owner: The owner the systems were registered with.
+		*/
+		void removeAll(const void*);
+		/*
+		* @return The timing statistics of each registered system in registration order.
+		*/
+		std::vector<Stats> getStats() const;
+		/*
+		* @return The time in seconds the systems took on the last fixed update.
+		*/
+		inline double getTickTime() const {
+			return tickTime_;
+		}
+		/*
+		* Log the timing statistics of each system and free this scheduler's memory.
+		*/
+		void destroy();
+
+	private:
+		// System registered with the scheduler.
+		struct SystemState {
+			// The ID of the system.
+			unsigned int id = 0;
+			// The owner to remove the system with.
+			const void* owner = 0;
+			// Whether the system was removed while systems were running.
+			bool removed = false;
+			// Callback updating the system.
+			System update;
+			// The timing statistics of the system.
+			Stats stats;
+		};
+
+		// The number of fixed updates per second.
+		double targetUPS_ = 60.0;
+		// The registered systems, stable so systems may register others while running.
+		std::list<SystemState> systems_;
+		// The ID of the next registered system.
+		unsigned int nextID_ = 0;
+		// The number of fixed updates run.
+		unsigned long long ticks_ = 0;
+		// Whether systems are running.
+		bool ticking_ = false;
+		// The time in seconds the systems took on the last fixed update.
+		double tickTime_ = 0.0;
+	};
+}
+
+#endif
\ No newline at end of file
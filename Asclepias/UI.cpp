@@ -15,7 +15,7 @@ namespace ASC {
 		cmpts_.clear();
 		nextID_ = 0;
 		shader_ = &shader;
-		font_ = font;
+		font_ = &font;
 		enabled_ = true;
 		visible_ = true;
 		prevWindowDims_ = App::window().getDims();
@@ -53,9 +53,11 @@ namespace ASC {
 
 	void UIGroup::draw() {
 		if (visible_) {
+			App::renderer().setOverlay(true);
 			for (UICmpt* cmpt : cmpts_) {
 				cmpt->draw();
 			}
+			App::renderer().setOverlay(false);
 		}
 	}
 
@@ -104,7 +106,7 @@ namespace ASC {
 		ID_ = 0;
 		nextID_ = 0;
 		shader_ = 0;
-		font_ = Renderer::NO_FONT;
+		font_ = &Renderer::NO_FONT;
 		enabled_ = true;
 		visible_ = true;
 		prevWindowDims_ = glm::ivec2();
@@ -148,6 +150,7 @@ namespace ASC {
 		parent_ = 0;
 		ID_ = 0;
 		bgSprite_.destroy();
+		textRun_.destroy();
 		text_ = "";
 		textScale_ = 1.0f;
 		textColor_ = glm::vec3();
@@ -179,8 +182,9 @@ namespace ASC {
 		App::renderer().submit(bgSprite_, parent_->getShader());
 		glm::vec3 textPos(bgSprite_.pos.x, bgSprite_.pos.y, bgSprite_.pos.z + 0.1f);
 		glm::vec4 textBounds(bgSprite_.pos.x, bgSprite_.pos.y, bgSprite_.dims.x, bgSprite_.dims.y);
-		App::renderer().submit(text_, textPos, textBounds, textScale_, textColor_, parent_->getFont(),
-			hAlign_, vAlign_, parent_->getShader());
+		textRun_.set(text_, textPos, textBounds, textScale_, textColor_, parent_->getFont(), hAlign_,
+			vAlign_);
+		App::renderer().submit(textRun_, parent_->getShader());
 	}
 
 	/*
@@ -327,8 +331,9 @@ namespace ASC {
 			break;
 		}
 		glm::vec4 textBounds(textPos.x, textPos.y, bgSprite_.dims.x, bgSprite_.dims.y);
-		App::renderer().submit(text_, textPos, textBounds, textScale_, textColor_, parent_->getFont(),
-			hAlign_, vAlign_, parent_->getShader());
+		textRun_.set(text_, textPos, textBounds, textScale_, textColor_, parent_->getFont(), hAlign_,
+			vAlign_);
+		App::renderer().submit(textRun_, parent_->getShader());
 	}
 
 	void Switch::processInput() {
@@ -384,8 +389,9 @@ namespace ASC {
 			break;
 		}
 		glm::vec4 textBounds(textPos.x, textPos.y, bgSprite_.dims.x, bgSprite_.dims.y);
-		App::renderer().submit(text_, textPos, textBounds, textScale_, textColor_, parent_->getFont(),
-			hAlign_, vAlign_, parent_->getShader());
+		textRun_.set(text_, textPos, textBounds, textScale_, textColor_, parent_->getFont(), hAlign_,
+			vAlign_);
+		App::renderer().submit(textRun_, parent_->getShader());
 		App::renderer().submit(cursor_, parent_->getShader());
 	}
 
@@ -462,6 +468,7 @@ namespace ASC {
 		values_.clear();
 		value_ = -1;
 		labelText_ = "";
+		labelRun_.destroy();
 		lAlign_ = ASC_ALIGN_TOP;
 		lHAlign_ = ASC_ALIGN_LEFT;
 		lVAlign_ = ASC_ALIGN_CENTER;
@@ -616,8 +623,9 @@ namespace ASC {
 		textBounds.y *= wd.y;
 		textBounds.z *= wd.x;
 		textBounds.w *= wd.y;
-		App::renderer().submit(labelText_, textPos, textBounds, textScale_, textColor_, parent_->getFont(),
+		labelRun_.set(labelText_, textPos, textBounds, textScale_, textColor_, parent_->getFont(),
 			lHAlign_, lVAlign_);
+		App::renderer().submit(labelRun_);
 		this->Label::draw();
 		prevB_.draw();
 		nextB_.draw();
@@ -663,7 +671,7 @@ namespace ASC {
 	}
 
 	void TextBox::setText(const std::string& text) {
-		if (text.length() > maxChars_ && maxChars_ > 0) {
+		if (LengthUTF8(text) > maxChars_ && maxChars_ > 0) {
 			return;
 		}
 		textPos_ = bgSprite_.pos.x;
@@ -671,17 +679,18 @@ namespace ASC {
 		text_ = text;
 	}
 
-	void TextBox::charTyped(char c) {
+	void TextBox::charTyped(unsigned int cp) {
 		if (!selected_) {
 			return;
 		}
-		if (text_.length() >= maxChars_ && maxChars_ > 0) {
-			text_.resize(maxChars_);
+		if (LengthUTF8(text_) >= maxChars_ && maxChars_ > 0) {
+			text_.resize(OffsetUTF8(text_, maxChars_));
 			return;
 		}
 		bool f = false;
-		for (char x : allowedChars_) {
-			if (x == c) {
+		size_t a = 0;
+		while (a < allowedChars_.size()) {
+			if (DecodeUTF8(allowedChars_, a) == cp) {
 				f = true;
 				break;
 			}
@@ -689,21 +698,9 @@ namespace ASC {
 		if (!(allowedChars_.empty() || f)) {
 			return;
 		}
-		std::string nt = "";
-		bool s = false;
-		for (unsigned int cp = 0; cp < text_.length(); cp++) {
-			if (cp == cursorPos_) {
-				nt += c;
-				s = true;
-			}
-			nt += text_.at(cp);
-		}
-		if (s) {
-			text_ = nt;
-		}
-		else {
-			text_ += c;
-		}
+		std::string c = "";
+		EncodeUTF8(cp, c);
+		text_.insert(OffsetUTF8(text_, cursorPos_), c);
 		cursorPos_++;
 	}
 
@@ -725,12 +722,14 @@ namespace ASC {
 			break;
 		}
 		glm::vec4 labelBounds(labelPos.x, labelPos.y, bgSprite_.dims.x, bgSprite_.dims.y);
-		App::renderer().submit(labelText_, labelPos, labelBounds, textScale_, textColor_,
-			parent_->getFont(), lHAlign_, lVAlign_, parent_->getShader());
+		labelRun_.set(labelText_, labelPos, labelBounds, textScale_, textColor_, parent_->getFont(),
+			lHAlign_, lVAlign_);
+		App::renderer().submit(labelRun_, parent_->getShader());
 		glm::vec3 textPos(textPos_, bgSprite_.pos.y, bgSprite_.pos.z + 0.1f);
 		glm::vec4 textBounds(bgSprite_.pos.x, bgSprite_.pos.y, bgSprite_.dims.x, bgSprite_.dims.y);
-		App::renderer().submit(text_, textPos, textBounds, textScale_, textColor_,
-			parent_->getFont(), hAlign_, vAlign_, parent_->getShader());
+		textRun_.set(text_, textPos, textBounds, textScale_, textColor_, parent_->getFont(), hAlign_,
+			vAlign_);
+		App::renderer().submit(textRun_, parent_->getShader());
 		if (selected_) {
 			App::renderer().submit(cursor_, parent_->getShader());
 		}
@@ -747,22 +746,17 @@ namespace ASC {
 				}
 				float x = textPos_;
 				unsigned int cp = 0;
-				bool s = false;
-				for (unsigned int i = 0; i < text_.length(); i++) {
-					float d = parent_->getFont().glyphs.at(text_.at(i)).offset * textScale_;
+				size_t i = 0;
+				while (i < text_.length()) {
+					const Glyph* g = parent_->getFont().getGlyph(DecodeUTF8(text_, i));
+					float d = (g == 0 ? 0.0f : g->offset * textScale_);
 					if (x + d >= mp.x) {
-						s = true;
-						cp = i;
 						break;
 					}
 					x += d;
+					cp++;
 				}
-				if (s) {
-					cursorPos_ = cp;
-				}
-				else {
-					cursorPos_ = (unsigned int)text_.length();
-				}
+				cursorPos_ = cp;
 			}
 			else {
 				if (selected_ && App::input().isMouseBtnPressed(ASC_MB_LEFT)) {
@@ -781,32 +775,22 @@ namespace ASC {
 				cursorPos_--;
 				timer_ = 0.0f;
 			}
-			if (cursorPos_ < text_.length() && (App::input().isKeyPressed(ASC_CTL_RIGHT)
+			if (cursorPos_ < LengthUTF8(text_) && (App::input().isKeyPressed(ASC_CTL_RIGHT)
 				|| (App::input().isKeyDown(ASC_CTL_RIGHT) && timer_ > 10.0f))) {
 				cursorPos_++;
 				timer_ = 0.0f;
 			}
 			if (cursorPos_ > 0 && (App::input().isKeyPressed(ASC_CTL_BACKSPACE)
 				|| (App::input().isKeyDown(ASC_CTL_BACKSPACE) && timer_ > 10.0f))) {
-				std::string nt = "";
-				for (unsigned int cp = 0; cp < text_.length(); cp++) {
-					if (cursorPos_ != cp + 1) {
-						nt += text_.at(cp);
-					}
-				}
-				text_ = nt;
+				size_t b = OffsetUTF8(text_, cursorPos_ - 1);
+				text_.erase(b, OffsetUTF8(text_, cursorPos_) - b);
 				cursorPos_--;
 				timer_ = 0.0f;
 			}
-			if (cursorPos_ < text_.length() && (App::input().isKeyPressed(ASC_CTL_DELETE)
+			if (cursorPos_ < LengthUTF8(text_) && (App::input().isKeyPressed(ASC_CTL_DELETE)
 				|| (App::input().isKeyDown(ASC_CTL_DELETE) && timer_ > 10.0f))) {
-				std::string nt = "";
-				for (unsigned int cp = 0; cp < text_.length(); cp++) {
-					if (cursorPos_ != cp) {
-						nt += text_.at(cp);
-					}
-				}
-				text_ = nt;
+				size_t b = OffsetUTF8(text_, cursorPos_);
+				text_.erase(b, OffsetUTF8(text_, cursorPos_ + 1) - b);
 				timer_ = 0.0f;
 			}
 		}
@@ -824,8 +808,12 @@ namespace ASC {
 		}
 		cursor_.pos = glm::vec3(textPos_, bgSprite_.pos.y, bgSprite_.pos.z + 0.2f);
 		cursor_.dims.y = bgSprite_.dims.y;
-		for (unsigned int cp = 0; cp < cursorPos_; cp++) {
-			cursor_.pos.x += parent_->getFont().glyphs.at(text_.at(cp)).offset * textScale_;
+		size_t i = 0;
+		for (unsigned int cp = 0; cp < cursorPos_ && i < text_.length(); cp++) {
+			const Glyph* g = parent_->getFont().getGlyph(DecodeUTF8(text_, i));
+			if (g != 0) {
+				cursor_.pos.x += g->offset * textScale_;
+			}
 		}
 		timer_ += dt;
 		if (timer_ > 60.0f) {
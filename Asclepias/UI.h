@@ -167,13 +167,13 @@ namespace ASC {
 		* @return This group's font.
 		*/
 		inline const Font& getFont() const override {
-			return font_;
+			return *font_;
 		}
 		/*
 		* @param const Font& font: This group's font.
 		*/
 		inline void setFont(const Font& font) {
-			font_ = font;
+			font_ = &font;
 		}
 		/*
 		* @return Whether this group's components are enabled.
@@ -209,8 +209,8 @@ namespace ASC {
 		unsigned int nextID_ = 0;
 		// Pointer to this group's shader.
 		Shader* shader_ = 0;
-		// This group's font.
-		Font& font_ = Renderer::NO_FONT;
+		// Pointer to this group's font.
+		const Font* font_ = &Renderer::NO_FONT;
 		// Whether this group's components are enabled.
 		bool enabled_ = true;
 		// Whether this group's components are visible.
@@ -321,6 +321,8 @@ namespace ASC {
 		Sprite bgSprite_;
 		// The text to display in this label.
 		std::string text_ = "";
+		// The laid out text of this label.
+		TextRun textRun_;
 		// The scale to display this label's text at.
 		float textScale_ = 1.0f;
 		// The color to display this label's text in.
@@ -663,6 +665,8 @@ namespace ASC {
 		int value_ = -1;
 		// The text to display in the label about this cycle's background.
 		std::string labelText_ = "";
+		// The laid out text of the label about this cycle's background.
+		TextRun labelRun_;
 		// The alignment of this cycle's label about its background.
 		Alignment lAlign_ = ASC_ALIGN_TOP;
 		// The horizontal alignment of the label's text in its bounds.
@@ -728,9 +732,9 @@ namespace ASC {
 		virtual void setText(const std::string&) override;
 		/*
 		* Callback for a character typed into this text box.
-		* @param char c: The character typed.
+		* @param unsigned int cp: The codepoint of the character typed.
 		*/
-		virtual void charTyped(char c) override;
+		virtual void charTyped(unsigned int cp) override;
 
 	protected:
 		// Texture coordinates for the unselected text box.
@@ -741,15 +745,17 @@ namespace ASC {
 		bool selected_ = false;
 		// The text to display about this text box's background.
 		std::string labelText_ = "";
+		// The laid out text to display about this text box's background.
+		TextRun labelRun_;
 		// The current position of the start of this box's main text.
 		float textPos_ = 0.0f;
 		// Sprite used to display this text box's cursor.
 		Sprite cursor_;
-		// The position of the cursor in the text box's main text.
+		// The position of the cursor in the text box's main text in codepoints.
 		unsigned int cursorPos_ = 0;
 		// Time tracking variable for repeating inputs.
 		float timer_ = 0.0f;
-		// Maximum number of characters allowed in this text box.
+		// Maximum number of codepoints allowed in this text box.
 		int maxChars_ = -1;
 		// Set of characters allowed in this text box.
 		std::string allowedChars_ = "";
@@ -9,7 +9,8 @@
 namespace ASC {
 	// Define WindowMgr functions.
 
-	bool WindowMgr::init(const glm::ivec2& dims, const std::string& title, bool fullscreen) {
+	bool WindowMgr::init(const glm::ivec2& dims, const std::string& title, bool fullscreen,
+		bool debug) {
 		if (window_ != 0) {
 			ASCLOG(Window, Warning, "Window already initialized.");
 			return false;
@@ -21,6 +22,7 @@ namespace ASC {
 		ASCLOG(Window, Info, "Initialized GLFW library.");
 		monitor_ = glfwGetPrimaryMonitor();
 		glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+		glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, debug ? GLFW_TRUE : GLFW_FALSE);
 		if (!fullscreen) {
 			window_ = glfwCreateWindow(dims.x, dims.y, title.c_str(), 0, 0);
 		}
@@ -37,12 +39,17 @@ namespace ASC {
 		setDims(dims);
 		setTitle(title);
 		glfwMakeContextCurrent(window_);
+		glfwSetWindowRefreshCallback(window_, RefreshEvent);
 		center();
 		return true;
 	}
 
-	bool WindowMgr::update() {
-		glfwSwapBuffers(window_);
+	bool WindowMgr::update(bool drawn) {
+		ASC_PROFILE_SCOPE("WindowMgr::update");
+		if (drawn) {
+			capture_.update(dims_);
+			glfwSwapBuffers(window_);
+		}
 		return !glfwWindowShouldClose(window_);
 	}
 
@@ -51,6 +58,7 @@ namespace ASC {
 			ASCLOG(Window, Warning, "Window already destroyed.");
 			return;
 		}
+		capture_.destroy();
 		glfwDestroyWindow(window_);
 		glfwTerminate();
 		ASCLOG(Window, Info, "Terminated GLFW library.");
@@ -58,6 +66,7 @@ namespace ASC {
 		wDims_ = glm::ivec2();
 		title_ = "";
 		fullscreen_ = false;
+		vsync_ = false;
 		monitor_ = 0;
 		window_ = 0;
 	}
@@ -100,8 +109,32 @@ namespace ASC {
 		monitor_ = monitor;
 	}
 
+	void WindowMgr::setVsync(bool vsync) {
+		vsync_ = vsync;
+		glfwSwapInterval(vsync ? 1 : 0);
+		App::pacer().setVsync(vsync);
+	}
+
+	void WindowMgr::setVisible(bool visible) {
+		if (visible) {
+			glfwShowWindow(window_);
+		}
+		else {
+			glfwHideWindow(window_);
+		}
+	}
+
+	int WindowMgr::getRefreshRate() const {
+		const GLFWvidmode* vm = glfwGetVideoMode(monitor_);
+		return vm != 0 ? vm->refreshRate : 60;
+	}
+
 	void WindowMgr::center() {
 		const GLFWvidmode* vm = glfwGetVideoMode(monitor_);
 		glfwSetWindowPos(window_, (vm->width - dims_.x) / 2, (vm->height - dims_.y) / 2);
 	}
+
+	void WindowMgr::RefreshEvent([[maybe_unused]] GLFWwindow* window) {
+		App::RequestRedraw();
+	}
 }
\ No newline at end of file
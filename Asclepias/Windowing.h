@@ -9,6 +9,9 @@
 
 #include <iostream>
 #include <string>
+
+#include "Capture.h"
+
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 
@@ -21,14 +24,17 @@ namespace ASC {
 		* @param const glm::ivec2& dims: The dimensions of ths window (w, h).
 		* @param const std::string& title: The title of the window.
 		* @param bool fullscreen: Whether to open this window in fullscreen mode.
+		* @param bool debug: Whether to request an OpenGL debug context.
 		* @return Whether GLFW could be initialize, and the window opened.
 		*/
-		bool init(const glm::ivec2&, const std::string&, bool);
+		bool init(const glm::ivec2&, const std::string&, bool, bool = false);
 		/*
-		* Swap the window's frame buffer.
+		* Read back the frame for any requested captures and swap the window's frame buffer.
+		* @param bool drawn: Whether a frame was drawn since the last update, false to leave the
+		* presented frame as is.
 		* @return Whether this window should remain open.
 		*/
-		bool update();
+		bool update(bool = true);
 		/*
 		* Free this window manager's memory.
 		*/
@@ -67,6 +73,30 @@ namespace ASC {
 		* @param GLFWmonitor* monitor: The monitor retrieved by GLFW to use for the window.
 		*/
 		void setMonitor(GLFWmonitor*);
+		/*
+		* @return Whether buffer swaps wait for vertical sync.
+		*/
+		inline bool isVsync() const {
+			return vsync_;
+		}
+		/*
+		* @param bool vsync: Whether buffer swaps should wait for vertical sync.
+		*/
+		void setVsync(bool);
+		/*
+		* @param bool visible: Whether this window is shown, hidden windows still render.
+		*/
+		void setVisible(bool);
+		/*
+		* @return The refresh rate in hertz of this window's monitor.
+		*/
+		int getRefreshRate() const;
+		/*
+		* @return This window's frame capture manager.
+		*/
+		inline CaptureMgr& capture() {
+			return capture_;
+		}
 
 	private:
 		friend class InputMgr;
@@ -79,15 +109,25 @@ namespace ASC {
 		std::string title_ = "";
 		// Whether this window is in fullscreen mode.
 		bool fullscreen_ = false;
+		// Whether buffer swaps wait for vertical sync.
+		bool vsync_ = false;
 		// The current monitor for this window.
 		GLFWmonitor* monitor_ = 0;
 		// The GLFW handle for this window.
 		GLFWwindow* window_ = 0;
+		// The manager capturing this window's frames to files.
+		CaptureMgr capture_;
 
 		/*
 		* Center the window on the screen.
 		*/
 		void center();
+		/*
+		* GLFW callback for the window's contents needing to be redrawn, such as after being
+		* uncovered.
+		* @param GLFWwindow* window: The GLFW window handle to redraw.
+		*/
+		static void RefreshEvent(GLFWwindow*);
 	};
 }
 
@@ -0,0 +1,45 @@
+/*
+* File:		Benchmark.cpp
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.10
+*/
+
+#include "Benchmark.h"
+
+// Define Benchmark entry point.
+
+/*
+* Usage: Benchmark [stress|jobs] [--out file] [--baseline file] [--tolerance fraction]
+* [--frames count] [--assets dir]
+*/
+int main(int argc, char** argv) {
+	std::string mode = argc > 1 && argv[1][0] != '-' ? argv[1] : "stress";
+	if (mode == "jobs") {
+		JobBenchmark::Run();
+		return EXIT_SUCCESS;
+	}
+	std::string outFile = "stress.json";
+	std::string baselineFile = "";
+	double tolerance = 0.1;
+	unsigned int frames = 300;
+	std::string assets = "../Sandbox/Assets/";
+	for (int i = 1; i + 1 < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--out") {
+			outFile = argv[++i];
+		}
+		else if (arg == "--baseline") {
+			baselineFile = argv[++i];
+		}
+		else if (arg == "--tolerance") {
+			tolerance = std::atof(argv[++i]);
+		}
+		else if (arg == "--frames") {
+			frames = (unsigned int)std::atoi(argv[++i]);
+		}
+		else if (arg == "--assets") {
+			assets = argv[++i];
+		}
+	}
+	return StressBenchmark::Run(outFile, baselineFile, tolerance, frames, assets);
+}
\ No newline at end of file
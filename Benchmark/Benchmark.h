@@ -0,0 +1,150 @@
+/*
+* File:		Benchmark.h
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.10
+*/
+
+#ifndef ASC_BENCHMARK_H
+#define ASC_BENCHMARK_H
+
+#include <chrono>
+#include <random>
+
+#include <Asclepias/Asclepias.h>
+
+using namespace ASC;
+
+// Declare benchmark suites.
+
+class JobBenchmark {
+public:
+	// Run each workload with 0 up to the default number of workers and print the scaling.
+	static void Run();
+
+private:
+	// Particle integrated by the data parallel workload.
+	struct Particle {
+		glm::vec2 pos;
+		glm::vec2 vel;
+		float rot;
+		float rotVel;
+	};
+
+	// Time a data parallel update of many particles with parallelFor.
+	static double ParallelFor(JobMgr&, std::vector<Particle>&, unsigned int);
+	// Time frames of small update jobs each followed by dependent draw jobs.
+	static double Dependencies(JobMgr&, std::vector<Particle>&, unsigned int);
+};
+
+// Kinds of load swept by the stress benchmark.
+enum StressWorkload {
+	STRESS_STATIC, STRESS_MOVING, STRESS_ANIMATED, STRESS_TEXT, STRESS_UI, STRESS_AUDIO,
+	STRESS_WORKLOADS
+};
+
+// Timing of one workload at one load.
+struct StressResult {
+	std::string workload;
+	unsigned int n = 0;
+	unsigned int frames = 0;
+	double meanMs = 0.0;
+	double p50Ms = 0.0;
+	double p90Ms = 0.0;
+	double p99Ms = 0.0;
+	double maxMs = 0.0;
+	double drawCalls = 0.0;
+	double arenaAllocs = 0.0;
+	double memoryMB = 0.0;
+};
+
+// Reference scene drawing each workload at each load of its sweep, then exiting the app.
+class StressScene : public Scene {
+public:
+	// Names of the workloads in results.
+	static const char* NAMES[STRESS_WORKLOADS];
+	// The loads each workload is swept through.
+	static const unsigned int SWEEPS[STRESS_WORKLOADS][4];
+	// Frames drawn before timing each load.
+	static const unsigned int WARMUP = 60;
+
+	// Construct a stress scene timing the given frames per load with assets from a directory.
+	StressScene(unsigned int, const std::string&);
+	// Overridden scene functions.
+	bool init() override;
+	void enter(Scene&) override;
+	void draw(float) override;
+	bool processInput() override;
+	void cmptEvent(unsigned int, unsigned int, unsigned int) override;
+	void update(float) override;
+	void leave(Scene&) override;
+	void destroy() override;
+	// Get the results of every finished load.
+	inline const std::vector<StressResult>& getResults() const {
+		return results_;
+	}
+
+private:
+	// Frames timed per load.
+	unsigned int frames_;
+	// Directory the Sandbox assets are loaded from.
+	std::string assets_;
+	// The current workload and index in its sweep.
+	unsigned int workload_ = 0;
+	unsigned int step_ = 0;
+	// Frames drawn at the current load.
+	unsigned int frame_ = 0;
+	// Time of the previous draw and frame times of the current load.
+	std::chrono::steady_clock::time_point last_;
+	std::vector<double> times_;
+	// Total draw calls of the timed frames.
+	unsigned long long drawCalls_ = 0;
+	// Total frame arena allocations of the timed frames.
+	unsigned long long arenaAllocs_ = 0;
+	// Generator placing entities the same way every run.
+	std::mt19937 random_;
+	// Assets shared by the workloads.
+	const Font* font_ = 0;
+	GLuint spriteTex_ = 0;
+	GLuint animTex_ = 0;
+	GLuint btnTex_ = 0;
+	std::string tone_ = "stress_tone.wav";
+	// Entities of the current load.
+	std::vector<Sprite> sprites_;
+	std::vector<Animation> anims_;
+	std::vector<std::string> lines_;
+	UIGroup ui_;
+	std::vector<Button> buttons_;
+	// Results of every finished load.
+	std::vector<StressResult> results_;
+
+	// Create the entities of the current workload and load.
+	void setup();
+	// Free the entities of the current workload.
+	void teardown();
+	// Record the result of the current load.
+	void finish();
+	// Write a short sine tone WAV for the audio workload.
+	static bool WriteTone(const std::string&);
+};
+
+// Runs the stress scene and writes or compares its results.
+class StressBenchmark {
+public:
+	// Run the stress scene, write JSON results and compare them to a baseline if given.
+	static int Run(const std::string&, const std::string&, double, unsigned int, const std::string&);
+
+private:
+	// Write results as JSON, one result per line.
+	static bool Write(const std::string&, const std::vector<StressResult>&);
+	// Read results written by Write().
+	static bool Read(const std::string&, std::vector<StressResult>&);
+	// Print the change from a baseline and count results slower than the tolerance allows.
+	static unsigned int Compare(const std::vector<StressResult>&, const std::vector<StressResult>&,
+		double);
+	// Get the memory used by this process in megabytes.
+	static double GetMemoryMB();
+
+	friend class StressScene;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,93 @@
+/*
+* File:		Jobs.cpp
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.10
+*/
+
+#include <chrono>
+#include <cstdio>
+
+#include "Benchmark.h"
+
+// Workload sizes.
+static const unsigned int PARTICLES = 1 << 20;
+static const unsigned int PASSES = 20;
+static const unsigned int FRAMES = 500;
+static const unsigned int FRAME_JOBS = 64;
+
+void JobBenchmark::Run() {
+	std::vector<Particle> particles(PARTICLES);
+	for (unsigned int i = 0; i < PARTICLES; i++) {
+		particles[i].pos = glm::vec2((float)(i % 1024), (float)(i / 1024));
+		particles[i].vel = glm::vec2(std::sin((float)i), std::cos((float)i));
+		particles[i].rot = 0.0f;
+		particles[i].rotVel = (float)(i % 7) - 3.0f;
+	}
+	unsigned int maxWorkers = JobMgr::GetDefaultWorkers();
+	double baseFor = 0.0, baseDeps = 0.0;
+	std::printf("Job system scaling, %u hardware threads.\n", std::thread::hardware_concurrency());
+	std::printf("%8s %12s %8s %12s %8s %10s\n", "threads", "for ms", "speedup", "deps ms", "speedup",
+		"steals");
+	for (unsigned int w = 0; w <= maxWorkers; w++) {
+		JobMgr jobs;
+		jobs.init(w);
+		ParallelFor(jobs, particles, 1);
+		double forMs = ParallelFor(jobs, particles, PASSES);
+		double depsMs = Dependencies(jobs, particles, FRAMES);
+		if (w == 0) {
+			baseFor = forMs;
+			baseDeps = depsMs;
+		}
+		std::printf("%8u %12.2f %7.2fx %12.2f %7.2fx %10llu\n", w + 1, forMs, baseFor / forMs,
+			depsMs, baseDeps / depsMs, jobs.getSteals());
+		jobs.destroy();
+	}
+}
+
+double JobBenchmark::ParallelFor(JobMgr& jobs, std::vector<Particle>& particles,
+	unsigned int passes) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned int p = 0; p < passes; p++) {
+		jobs.parallelFor(0, (unsigned int)particles.size(), [&particles](unsigned int i) {
+			Particle& pt = particles[i];
+			pt.pos += pt.vel;
+			pt.rot += pt.rotVel;
+			float a = pt.rot * (3.14159265f / 180.0f);
+			pt.vel = glm::vec2(std::cos(a) * pt.vel.x - std::sin(a) * pt.vel.y,
+				std::sin(a) * pt.vel.x + std::cos(a) * pt.vel.y) * 0.999f;
+		});
+	}
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+		.count() / passes;
+}
+
+double JobBenchmark::Dependencies(JobMgr& jobs, std::vector<Particle>& particles,
+	unsigned int frames) {
+	unsigned int slice = (unsigned int)particles.size() / 16 / FRAME_JOBS;
+	std::vector<float> extents(FRAME_JOBS);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned int f = 0; f < frames; f++) {
+		JobCounter updated, drawn;
+		for (unsigned int j = 0; j < FRAME_JOBS; j++) {
+			jobs.submit([&particles, slice, j]() {
+				for (unsigned int i = j * slice; i < (j + 1) * slice; i++) {
+					particles[i].pos += particles[i].vel;
+					particles[i].rot += particles[i].rotVel;
+				}
+			}, &updated);
+		}
+		for (unsigned int j = 0; j < FRAME_JOBS; j++) {
+			jobs.submit([&particles, &extents, slice, j]() {
+				float e = 0.0f;
+				for (unsigned int i = j * slice; i < (j + 1) * slice; i++) {
+					e = std::max(e, glm::length(particles[i].pos));
+				}
+				extents[j] = e;
+			}, &drawn, &updated);
+		}
+		jobs.wait(drawn);
+		jobs.wait(updated);
+	}
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+		.count() / frames;
+}
\ No newline at end of file
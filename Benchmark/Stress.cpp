@@ -0,0 +1,414 @@
+/*
+* File:		Stress.cpp
+* Author:	WebSkelter (webskelter@gmail.com)
+* Created:	2023.03.10
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+#include "Benchmark.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <psapi.h>
+#endif
+
+// Define stress scene values.
+
+const char* StressScene::NAMES[STRESS_WORKLOADS] = {
+	"static_sprites", "moving_sprites", "animated_sprites", "text_wall", "ui_widgets", "audio_spam"
+};
+const unsigned int StressScene::SWEEPS[STRESS_WORKLOADS][4] = {
+	{ 1000, 10000, 50000, 100000 },
+	{ 1000, 10000, 50000, 100000 },
+	{ 1000, 10000, 25000, 50000 },
+	// Characters of text.
+	{ 1000, 5000, 20000, 50000 },
+	// Buttons.
+	{ 16, 64, 256, 1024 },
+	// Effects played per update.
+	{ 1, 4, 16, 64 },
+};
+
+// Characters per line of the text wall.
+static const unsigned int LINE_CHARS = 80;
+
+StressScene::StressScene(unsigned int frames, const std::string& assets) : frames_(frames),
+	assets_(assets), random_(1) {}
+
+bool StressScene::init() {
+	font_ = &App::renderer().getFont(assets_ + "fonts/cour.ttf");
+	spriteTex_ = App::renderer().getTexture(assets_ + "images/slider_cursor.png");
+	animTex_ = App::renderer().getTexture(assets_ + "images/button.png");
+	btnTex_ = animTex_;
+	if (!WriteTone(tone_)) {
+		ASCLOG(Stress, Warning, "Failed to write ", tone_, ", audio spam will be silent.");
+	}
+	App::audio().preloadEffect(tone_);
+	App::renderer().getShader().getCamera().pos = glm::vec3(
+		App::window().getDims().x / 2, App::window().getDims().y / 2, 0.0f);
+	setup();
+	ASCLOG(Stress, Info, "Initialized stress scene.");
+	return true;
+}
+
+void StressScene::enter(Scene& prev) {
+	ASCLOG(Stress, Info, "Entered stress scene from ", &prev, ".");
+}
+
+void StressScene::draw(float alpha) {
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (frame_ > WARMUP) {
+		times_.push_back(std::chrono::duration<double, std::milli>(now - last_).count());
+		drawCalls_ += App::renderer().getFrameDrawCalls();
+		arenaAllocs_ += App::frameArena().getFrameAllocations();
+	}
+	last_ = now;
+	frame_++;
+
+	switch (workload_) {
+	case STRESS_STATIC:
+	case STRESS_MOVING:
+		App::renderer().submit(sprites_);
+		break;
+	case STRESS_ANIMATED:
+		App::renderer().submit(anims_);
+		break;
+	case STRESS_TEXT: {
+		// Change one line a frame so layout is exercised as well as the cache.
+		std::string& line = lines_[frame_ % lines_.size()];
+		std::rotate(line.begin(), line.begin() + 1, line.end());
+		float w = (float)App::window().getDims().x;
+		float h = (float)App::window().getDims().y / lines_.size();
+		for (unsigned int i = 0; i < lines_.size(); i++) {
+			App::renderer().submit(lines_[i], glm::vec3(0.0f, i * h, 0.0f),
+				glm::vec4(0.0f, i * h, w, h), 0.25f, glm::vec3(1.0f, 1.0f, 1.0f), *font_,
+				ASC_ALIGN_LEFT, ASC_ALIGN_BOTTOM);
+		}
+		break;
+	}
+	case STRESS_UI:
+		ui_.draw();
+		break;
+	}
+}
+
+bool StressScene::processInput() {
+	if (App::input().isKeyPressed(ASC_CTL_ESC)) {
+		return false;
+	}
+	if (workload_ == STRESS_UI) {
+		ui_.processInput();
+	}
+	if (frame_ <= WARMUP + frames_) {
+		return true;
+	}
+	finish();
+	teardown();
+	if (++step_ >= 4) {
+		step_ = 0;
+		workload_++;
+	}
+	if (workload_ >= STRESS_WORKLOADS) {
+		return false;
+	}
+	setup();
+	return true;
+}
+
+void StressScene::cmptEvent(unsigned int gID, unsigned int cID, unsigned int eID) {
+
+}
+
+void StressScene::update(float dt) {
+	switch (workload_) {
+	case STRESS_MOVING: {
+		glm::vec2 wd = glm::vec2(App::window().getDims());
+		for (Sprite& s : sprites_) {
+			s.update(dt);
+			if (s.pos.x < 0.0f || s.pos.x > wd.x) {
+				s.vel.x = -s.vel.x;
+			}
+			if (s.pos.y < 0.0f || s.pos.y > wd.y) {
+				s.vel.y = -s.vel.y;
+			}
+		}
+		break;
+	}
+	case STRESS_ANIMATED:
+		for (Animation& a : anims_) {
+			a.update(dt);
+		}
+		break;
+	case STRESS_UI:
+		ui_.update(dt);
+		break;
+	case STRESS_AUDIO:
+		for (unsigned int i = 0; i < SWEEPS[workload_][step_]; i++) {
+			App::audio().playEffect(tone_);
+		}
+		break;
+	}
+}
+
+void StressScene::leave(Scene& next) {
+	ASCLOG(Stress, Info, "Left stress scene for ", &next, ".");
+}
+
+void StressScene::destroy() {
+	teardown();
+	ASCLOG(Stress, Info, "Destroyed stress scene.");
+}
+
+void StressScene::setup() {
+	unsigned int n = SWEEPS[workload_][step_];
+	glm::vec2 wd = glm::vec2(App::window().getDims());
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	switch (workload_) {
+	case STRESS_STATIC:
+	case STRESS_MOVING:
+		sprites_.resize(n);
+		for (Sprite& s : sprites_) {
+			s.init(glm::vec3(unit(random_) * wd.x, unit(random_) * wd.y, 0.0f),
+				glm::vec2(16.0f, 16.0f), spriteTex_);
+			if (workload_ == STRESS_MOVING) {
+				s.vel = glm::vec2(unit(random_) * 4.0f - 2.0f, unit(random_) * 4.0f - 2.0f);
+				s.rotVel = unit(random_) * 6.0f - 3.0f;
+			}
+		}
+		break;
+	case STRESS_ANIMATED:
+		anims_.resize(n);
+		for (Animation& a : anims_) {
+			a.init(glm::vec3(unit(random_) * wd.x, unit(random_) * wd.y, 0.0f),
+				glm::vec2(32.0f, 16.0f), animTex_, glm::ivec2(3, 1), 5.0f + unit(random_) * 10.0f);
+			a.play();
+		}
+		break;
+	case STRESS_TEXT:
+		lines_.resize((n + LINE_CHARS - 1) / LINE_CHARS);
+		for (std::string& line : lines_) {
+			line.resize(LINE_CHARS);
+			for (char& c : line) {
+				c = (char)('!' + (unsigned int)(unit(random_) * 94.0f));
+			}
+		}
+		break;
+	case STRESS_UI: {
+		ui_.init(*this, 0, App::renderer().getShader(), *font_);
+		// Buttons are added by reference, so the vector must not grow after this.
+		buttons_.resize(n);
+		unsigned int cols = (unsigned int)std::ceil(std::sqrt((float)n));
+		float cell = 1.0f / cols;
+		for (unsigned int i = 0; i < n; i++) {
+			buttons_[i].init(glm::vec3((i % cols) * cell, (i / cols) * cell, 0.0f),
+				glm::vec2(cell * 0.9f, cell * 0.9f), btnTex_, std::to_string(i), 0.25f,
+				glm::vec3(1.0f, 1.0f, 1.0f));
+			ui_.addCmpt(buttons_[i]);
+		}
+		break;
+	}
+	}
+	frame_ = 0;
+	times_.clear();
+	drawCalls_ = 0;
+	arenaAllocs_ = 0;
+	ASCLOG(Stress, Info, "Running ", NAMES[workload_], " at ", n, ".");
+}
+
+void StressScene::teardown() {
+	for (Sprite& s : sprites_) {
+		s.destroy();
+	}
+	sprites_.clear();
+	for (Animation& a : anims_) {
+		a.destroy();
+	}
+	anims_.clear();
+	lines_.clear();
+	if (!buttons_.empty()) {
+		ui_.destroy();
+		buttons_.clear();
+	}
+}
+
+void StressScene::finish() {
+	StressResult r;
+	r.workload = NAMES[workload_];
+	r.n = SWEEPS[workload_][step_];
+	r.frames = (unsigned int)times_.size();
+	if (!times_.empty()) {
+		std::vector<double> sorted = times_;
+		std::sort(sorted.begin(), sorted.end());
+		double total = 0.0;
+		for (double t : sorted) {
+			total += t;
+		}
+		r.meanMs = total / sorted.size();
+		r.p50Ms = sorted[(size_t)(0.50 * (sorted.size() - 1) + 0.5)];
+		r.p90Ms = sorted[(size_t)(0.90 * (sorted.size() - 1) + 0.5)];
+		r.p99Ms = sorted[(size_t)(0.99 * (sorted.size() - 1) + 0.5)];
+		r.maxMs = sorted.back();
+		r.drawCalls = (double)drawCalls_ / sorted.size();
+		r.arenaAllocs = (double)arenaAllocs_ / sorted.size();
+	}
+	r.memoryMB = StressBenchmark::GetMemoryMB();
+	std::printf("%-18s %7u %9.3f %9.3f %9.3f %9.3f %9.1f %9.1f %9.1f\n", r.workload.c_str(), r.n,
+		r.meanMs, r.p50Ms, r.p99Ms, r.maxMs, r.drawCalls, r.arenaAllocs, r.memoryMB);
+	results_.push_back(r);
+}
+
+bool StressScene::WriteTone(const std::string& fileName) {
+	const unsigned int rate = 22050, samples = rate / 20;
+	std::ofstream file(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+	unsigned int dataSize = samples * 2, riffSize = 36 + dataSize, fmtSize = 16, byteRate = rate * 2;
+	unsigned short format = 1, channels = 1, align = 2, bits = 16;
+	file.write("RIFF", 4);
+	file.write((const char*)&riffSize, 4);
+	file.write("WAVEfmt ", 8);
+	file.write((const char*)&fmtSize, 4);
+	file.write((const char*)&format, 2);
+	file.write((const char*)&channels, 2);
+	file.write((const char*)&rate, 4);
+	file.write((const char*)&byteRate, 4);
+	file.write((const char*)&align, 2);
+	file.write((const char*)&bits, 2);
+	file.write("data", 4);
+	file.write((const char*)&dataSize, 4);
+	for (unsigned int i = 0; i < samples; i++) {
+		short s = (short)(std::sin(i * 880.0f * 6.2831853f / rate) * 8000.0f);
+		file.write((const char*)&s, 2);
+	}
+	return file.good();
+}
+
+// Define stress benchmark functions.
+
+int StressBenchmark::Run(const std::string& outFile, const std::string& baselineFile,
+	double tolerance, unsigned int frames, const std::string& assets) {
+	StressScene scene(frames, assets);
+	App::Config conf(scene);
+	conf.window.title = "Asclepias Stress Benchmark";
+	conf.window.dims = glm::ivec2(1280, 720);
+	conf.window.targetFPS = -1.0;
+	conf.log.traceKey = ASC_CTL_F12;
+	if (!App::Init(conf)) {
+		return EXIT_FAILURE;
+	}
+	std::printf("%-18s %7s %9s %9s %9s %9s %9s %9s %9s\n", "workload", "n", "mean ms", "p50 ms",
+		"p99 ms", "max ms", "draws", "allocs", "mem MB");
+	App::Run();
+	App::Destroy();
+
+	const std::vector<StressResult>& results = scene.getResults();
+	if (!Write(outFile, results)) {
+		std::printf("Failed to write results to %s.\n", outFile.c_str());
+		return EXIT_FAILURE;
+	}
+	std::printf("Wrote %zu results to %s.\n", results.size(), outFile.c_str());
+	if (baselineFile.empty()) {
+		return EXIT_SUCCESS;
+	}
+	std::vector<StressResult> baseline;
+	if (!Read(baselineFile, baseline)) {
+		std::printf("Failed to read baseline %s.\n", baselineFile.c_str());
+		return EXIT_FAILURE;
+	}
+	unsigned int regressions = Compare(baseline, results, tolerance);
+	std::printf("%u regressions past %.0f%% of %s.\n", regressions, tolerance * 100.0,
+		baselineFile.c_str());
+	return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+bool StressBenchmark::Write(const std::string& fileName, const std::vector<StressResult>& results) {
+	std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+	file << "{\"benchmark\": \"stress\", \"results\": [";
+	for (size_t i = 0; i < results.size(); i++) {
+		const StressResult& r = results[i];
+		file << (i == 0 ? "\n" : ",\n") << "{\"workload\": \"" << r.workload << "\", \"n\": " << r.n
+			<< ", \"frames\": " << r.frames << ", \"mean_ms\": " << r.meanMs
+			<< ", \"p50_ms\": " << r.p50Ms << ", \"p90_ms\": " << r.p90Ms
+			<< ", \"p99_ms\": " << r.p99Ms << ", \"max_ms\": " << r.maxMs
+			<< ", \"draw_calls\": " << r.drawCalls << ", \"arena_allocs\": " << r.arenaAllocs
+			<< ", \"memory_mb\": " << r.memoryMB << "}";
+	}
+	file << "\n]}\n";
+	return file.good();
+}
+
+// Get the number after a key on a line written by StressBenchmark::Write().
+static double GetField(const std::string& line, const std::string& key) {
+	size_t at = line.find("\"" + key + "\": ");
+	return at == std::string::npos ? 0.0 : std::atof(line.c_str() + at + key.size() + 4);
+}
+
+bool StressBenchmark::Read(const std::string& fileName, std::vector<StressResult>& results) {
+	std::ifstream file(fileName);
+	if (!file.is_open()) {
+		return false;
+	}
+	std::string line;
+	while (std::getline(file, line)) {
+		size_t at = line.find("\"workload\": \"");
+		if (at == std::string::npos) {
+			continue;
+		}
+		at += 13;
+		StressResult r;
+		r.workload = line.substr(at, line.find('"', at) - at);
+		r.n = (unsigned int)GetField(line, "n");
+		r.frames = (unsigned int)GetField(line, "frames");
+		r.meanMs = GetField(line, "mean_ms");
+		r.p50Ms = GetField(line, "p50_ms");
+		r.p90Ms = GetField(line, "p90_ms");
+		r.p99Ms = GetField(line, "p99_ms");
+		r.maxMs = GetField(line, "max_ms");
+		r.drawCalls = GetField(line, "draw_calls");
+		r.arenaAllocs = GetField(line, "arena_allocs");
+		r.memoryMB = GetField(line, "memory_mb");
+		results.push_back(r);
+	}
+	return true;
+}
+
+unsigned int StressBenchmark::Compare(const std::vector<StressResult>& baseline,
+	const std::vector<StressResult>& results, double tolerance) {
+	unsigned int regressions = 0;
+	std::printf("%-18s %7s %16s %16s %14s\n", "workload", "n", "p50 ms", "p99 ms", "draws");
+	for (const StressResult& r : results) {
+		std::vector<StressResult>::const_iterator b = std::find_if(baseline.begin(), baseline.end(),
+			[&r](const StressResult& b) {
+			return b.workload == r.workload && b.n == r.n;
+		});
+		if (b == baseline.end()) {
+			std::printf("%-18s %7u not in baseline\n", r.workload.c_str(), r.n);
+			continue;
+		}
+		bool slower = r.p50Ms > b->p50Ms * (1.0 + tolerance) || r.p99Ms > b->p99Ms * (1.0 + tolerance)
+			|| r.drawCalls > b->drawCalls * (1.0 + tolerance);
+		regressions += slower ? 1 : 0;
+		std::printf("%-18s %7u %7.3f>%7.3f %7.3f>%7.3f %6.0f>%6.0f %s\n", r.workload.c_str(), r.n,
+			b->p50Ms, r.p50Ms, b->p99Ms, r.p99Ms, b->drawCalls, r.drawCalls,
+			slower ? "REGRESSED" : "ok");
+	}
+	return regressions;
+}
+
+double StressBenchmark::GetMemoryMB() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+		return pmc.WorkingSetSize / (1024.0 * 1024.0);
+	}
+#endif
+	return 0.0;
+}
\ No newline at end of file
@@ -15,7 +15,7 @@ void GameScene::enter(Scene& prev) {
 	ASCLOG(Game, Info, "Entered game scene from ", &prev, ".");
 }
 
-void GameScene::draw() {
+void GameScene::draw(float alpha) {
 
 }
 
@@ -78,7 +78,7 @@ bool OptionsScene::init() {
 	float csrWidth = 10.0f;
 
 	// Create main UI group.
-	mainUI_.init(*this, 0, App::renderer().getShader(), Sandbox::FONT);
+	mainUI_.init(*this, 0, App::renderer().getShader(), *Sandbox::FONT);
 	backBtn_.init(glm::vec3(0.0f, 0.0f, 0.0f), mainBtnDims, Sandbox::BTN_TEX,
 		"BACK", Sandbox::TEXT_SCALE, Sandbox::TEXT_COLOR);
 	mainUI_.addCmpt(backBtn_);
@@ -90,7 +90,7 @@ bool OptionsScene::init() {
 	mainUI_.addCmpt(applyBtn_);
 
 	// Create options UI group.
-	optionsUI_.init(*this, 1, App::renderer().getShader(), Sandbox::FONT);
+	optionsUI_.init(*this, 1, App::renderer().getShader(), *Sandbox::FONT);
 	windowDimsCyc_.init(glm::vec3(0.25f, 0.8f, 0.0f), optionDims, Sandbox::CYC_TEX,
 		Sandbox::CYC_BTN_TEX, { "800x600", "1080x720", "1920x1080" }, "RESOLUTION",
 		"", "", Sandbox::TEXT_SCALE, Sandbox::TEXT_COLOR, ASC_ALIGN_CENTER,
@@ -125,7 +125,7 @@ void OptionsScene::enter(Scene& prev) {
 	ASCLOG(Options, Info, "Entered options scene from ", &prev, ".");
 }
 
-void OptionsScene::draw() {
+void OptionsScene::draw(float alpha) {
 	mainUI_.draw();
 	optionsUI_.draw();
 }
@@ -193,4 +193,9 @@ void OptionsScene::destroy() {
 	optionsUI_.destroy();
 
 	ASCLOG(Options, Info, "Destroyed options scene.");
+}
+
+bool OptionsScene::isAnimating() const {
+	// Only changes on input.
+	return false;
 }
\ No newline at end of file
@@ -8,7 +8,7 @@
 
 // Define global Sandbox variables.
 
-Font& Sandbox::FONT = Renderer::NO_FONT;
+const Font* Sandbox::FONT = &Renderer::NO_FONT;
 GLuint Sandbox::BTN_TEX = Renderer::NO_TEXTURE;
 GLuint Sandbox::CYC_TEX = Renderer::NO_TEXTURE;
 GLuint Sandbox::CYC_BTN_TEX = Renderer::NO_TEXTURE;
@@ -33,12 +33,31 @@ int main(int argc, char** argv) {
 	conf.window.dims = OptionsScene::WINDOW_DIMS;
 	conf.window.fullscreen = OptionsScene::FULLSCREEN;
 	conf.audio.volume = OptionsScene::VOLUME;
+	conf.log.profile = true;
+	conf.log.traceKey = ASC_CTL_F12;
+	conf.governor.enabled = true;
+	conf.governor.minRenderScale = 0.5f;
+	conf.window.idle = true;
+	conf.assets.fonts = { "Assets/fonts/cour.ttf" };
+	conf.assets.textures = { "Assets/images/button.png", "Assets/images/cycle.png",
+		"Assets/images/cycle_button.png", "Assets/images/switch.png", "Assets/images/slider.png",
+		"Assets/images/slider_cursor.png" };
+	for (int i = 1; i + 1 < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--record") {
+			conf.input.recordFile = argv[++i];
+		}
+		else if (arg == "--replay" || arg == "--replay-headless") {
+			conf.input.replayFile = argv[++i];
+			conf.input.replayHeadless = arg == "--replay-headless";
+		}
+	}
 	if (!App::Init(conf)) {
 		return EXIT_FAILURE;
 	}
 
-	// Load global values.
-	Sandbox::FONT = App::renderer().getFont("Assets/fonts/cour.ttf");
+	// Load global values, uploaded by App::Init().
+	Sandbox::FONT = &App::renderer().getFont("Assets/fonts/cour.ttf");
 	Sandbox::BTN_TEX = App::renderer().getTexture("Assets/images/button.png");
 	Sandbox::CYC_TEX = App::renderer().getTexture("Assets/images/cycle.png");
 	Sandbox::CYC_BTN_TEX = App::renderer().getTexture("Assets/images/cycle_button.png");
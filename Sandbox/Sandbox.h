@@ -18,12 +18,13 @@ public:
 	// Overridden scene functions.
 	bool init() override;
 	void enter(Scene&) override;
-	void draw() override;
+	void draw(float) override;
 	bool processInput() override;
 	void cmptEvent(unsigned int, unsigned int, unsigned int) override;
 	void update(float) override;
 	void leave(Scene&) override;
 	void destroy() override;
+	bool isAnimating() const override;
 
 private:
 	// Main UI group.
@@ -48,12 +49,13 @@ public:
 	// Overridden scene functions.
 	bool init() override;
 	void enter(Scene&) override;
-	void draw() override;
+	void draw(float) override;
 	bool processInput() override;
 	void cmptEvent(unsigned int, unsigned int, unsigned int) override;
 	void update(float) override;
 	void leave(Scene&) override;
 	void destroy() override;
+	bool isAnimating() const override;
 
 private:
 	// Main UI group on bottom.
@@ -75,7 +77,7 @@ class GameScene : public Scene {
 public:
 	bool init() override;
 	void enter(Scene&) override;
-	void draw() override;
+	void draw(float) override;
 	bool processInput() override;
 	void cmptEvent(unsigned int, unsigned int, unsigned int) override;
 	void update(float) override;
@@ -88,7 +90,7 @@ public:
 class Sandbox {
 public:
 	// Global variables.
-	static Font& FONT;
+	static const Font* FONT;
 	static GLuint BTN_TEX;
 	static GLuint CYC_TEX;
 	static GLuint CYC_BTN_TEX;
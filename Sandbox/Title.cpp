@@ -13,7 +13,7 @@ bool TitleScene::init() {
 	glm::vec2 btnDims(0.5f, 0.15f);
 
 	// Create main UI group.
-	UI_.init(*this, 0, App::renderer().getShader(), Sandbox::FONT);
+	UI_.init(*this, 0, App::renderer().getShader(), *Sandbox::FONT);
 	startBtn_.init(glm::vec3(0.25f, 0.5f, 0.0f), btnDims, Sandbox::BTN_TEX,
 		"START", Sandbox::TEXT_SCALE, Sandbox::TEXT_COLOR);
 	UI_.addCmpt(startBtn_);
@@ -35,7 +35,7 @@ void TitleScene::enter(Scene& prev) {
 	ASCLOG(Title, Info, "Entered title scene from ", &prev, ".");
 }
 
-void TitleScene::draw() {
+void TitleScene::draw(float alpha) {
 	UI_.draw();
 }
 
@@ -76,4 +76,9 @@ void TitleScene::destroy() {
 	UI_.destroy();
 
 	ASCLOG(Title, Info, "Destroyed title scene.");
+}
+
+bool TitleScene::isAnimating() const {
+	// Only changes on input.
+	return false;
 }
\ No newline at end of file